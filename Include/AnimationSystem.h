@@ -0,0 +1,94 @@
+#pragma once
+
+#include "StandardIncludes.h"
+#include "Singleton.h"
+#include "Texture.h"
+#include "AssetTable.h"
+
+// A horizontal sprite strip described by Assets/Animations/clips.txt.
+// Frame rects are computed once when the clip's texture is loaded.
+struct AnimationClip {
+    std::string Name;
+    AssetId Id;                        // Hash of Name
+    Texture* SheetTexture;
+    std::vector<SDL_FRect> Frames;
+    std::vector<float> FrameDurations; // In playback units; 1.0 = one tick at rate 1
+    bool Loop;
+    std::string EndEvent;              // Raised when a one-shot clip finishes
+};
+
+class AnimationListener {
+public:
+    virtual ~AnimationListener() {}
+    virtual void OnAnimationEnd(int clipId, const std::string& event) = 0;
+};
+
+class AnimationSystem : public Singleton<AnimationSystem> {
+public:
+    AnimationSystem();
+    virtual ~AnimationSystem();
+
+    bool LoadClips(const std::string& filepath);
+    void Shutdown();
+
+    // Plays library's clips without loading them again; library keeps
+    // ownership of the sheet textures and must outlive this system
+    void ShareClips(const AnimationSystem& library);
+
+    // Recomputes frame rects for clips drawn from a reloaded texture
+    void RefreshClips(Texture* texture);
+
+    int FindClip(AssetId id) const;
+    const AnimationClip& GetClip(int clipId) const { return m_clips[clipId]; }
+
+    // Instances are handles into packed state owned by the system
+    int CreateInstance(AnimationListener* listener);
+    void ReleaseInstance(int instance);
+
+    void Play(int instance, int clipId, float rate);
+    void Stop(int instance) { m_playing[instance] = 0; }
+    void SetState(int instance, int frame, float timer);
+
+    // Advances every playing instance, then dispatches end events. Timers
+    // advance several instances at a time with AVX when the CPU has it (see
+    // CpuFeatures) or SSE2, and the instances whose frame ends are picked
+    // out with a compare mask; only those step through their clip one at a
+    // time.
+    void Update(float deltaTime);
+
+    // One instance at a time with a branch; Update() gives the same
+    // results bit for bit
+    void UpdateReference(float deltaTime);
+
+    int GetFrame(int instance) const { return m_frames[instance]; }
+    float GetTimer(int instance) const { return m_timers[instance]; }
+    Texture* GetTexture(int instance) const {
+        return m_clipIds[instance] >= 0 ? m_clips[m_clipIds[instance]].SheetTexture : nullptr;
+    }
+    const SDL_FRect& GetSourceRect(int instance) const { return m_srcRects[instance]; }
+
+private:
+    void BuildFrameRects(AnimationClip& clip, int frameCount);
+
+    // Moves an instance whose timer has reached its frame's duration on to
+    // the frame the timer falls in
+    void AdvanceFrames(int instance);
+    void DispatchFinished();
+
+    std::vector<AnimationClip> m_clips;
+    AssetTable<int> m_clipIndex;
+    bool m_sharedClips;
+
+    // Packed per-instance state, indexed by instance handle
+    std::vector<float> m_timers;
+    std::vector<float> m_rates;
+    std::vector<float> m_frameDurations;   // Of each instance's current frame
+    std::vector<int> m_frames;
+    std::vector<int> m_clipIds;
+    std::vector<uint32_t> m_playing;       // All ones or zero, so it doubles as a lane mask
+    std::vector<SDL_FRect> m_srcRects;
+    std::vector<AnimationListener*> m_listeners;
+    std::vector<int> m_freeInstances;
+
+    std::vector<int> m_finished;
+};
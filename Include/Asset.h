@@ -8,16 +8,14 @@ struct ImageInfo {
     int Height;
     int BitsPerPixel;
     unsigned char* Data;
+    bool Premultiplied = false;   // Colour already scaled by alpha (cooked textures)
+    bool Mapped = false;          // Data points into a mounted archive: read-only, not owned
 };
 
+// A loaded file's bytes; the memory belongs to the allocator it came from
 class Asset {
 public:
     Asset() : m_data(nullptr), m_size(0) {}
-    ~Asset() {
-        if (m_data) {
-            free(m_data);
-        }
-    }
 
     void SetData(void* data, size_t size) {
         m_data = data;
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "AssetId.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Read-only .pak archive mapped into memory once. Layout:
+//   PakHeader | PakEntry[EntryCount] sorted by PathHash | path names |
+//   entry data, each starting on a 4 KB boundary
+class AssetArchive {
+public:
+    static const uint32_t VERSION = 1;
+    static const uint64_t ALIGNMENT = 4096;
+
+    struct PakHeader {
+        char Magic[4];           // "PAK1"
+        uint32_t Version;
+        uint32_t EntryCount;
+        uint32_t NamesSize;
+        uint64_t IndexOffset;
+        uint64_t NamesOffset;
+    };
+
+    struct PakEntry {
+        uint64_t PathHash;
+        uint64_t Offset;
+        uint64_t Size;
+        uint32_t NameOffset;
+        uint32_t NameLength;
+    };
+
+    AssetArchive();
+    ~AssetArchive();
+
+    bool Open(const std::string& filepath);
+    void Close();
+    bool IsOpen() const { return m_base != nullptr; }
+
+    // Returns a view into the mapping; valid until Close()
+    bool Find(const std::string& path, const unsigned char*& data, size_t& size) const;
+
+    // Lookup by id alone; Pack() rejects colliding paths, so no name check
+    bool Find(AssetId id, const unsigned char*& data, size_t& size) const;
+
+    // Recovers the path stored for id in the name table
+    bool FindPath(AssetId id, std::string& path) const;
+
+    // Packs every file under directory, keyed by its path relative to the
+    // directory's parent (e.g. "Assets/Textures/rock.tga")
+    static bool Pack(const std::string& directory, const std::string& outputPath);
+
+private:
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    const PakEntry* FindEntry(uint64_t hash) const;
+
+    const unsigned char* m_base;
+    size_t m_size;
+    const PakHeader* m_header;
+    const PakEntry* m_entries;
+    const char* m_names;
+
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#endif
+};
@@ -4,20 +4,60 @@
 #include "Singleton.h"
 #include "StackAllocator.h"
 #include "Asset.h"
+#include "AssetTable.h"
 #include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+class Texture;
 
 class AssetController : public Singleton<AssetController> {
 public:
     AssetController();
     virtual ~AssetController();
 
-    void Initialize(size_t stackSize);
+    void Initialize(size_t reserveSize);
     void Shutdown();
 
     Asset* LoadAsset(const std::string& filepath);
-    void UnloadAsset(const std::string& filepath);
+    Asset* FindAsset(AssetId id);
+    void UnloadAsset(AssetId id);
+
+    // Records the id of every file under directory, keyed like the archive
+    // (e.g. "Assets/Textures/rock.tga"), so saves resolve without one.
+    // Call before other threads resolve ids.
+    bool RegisterPaths(const std::string& directory);
+
+    // Path for an id saved to disk: the mounted archive's name table, then
+    // the registered loose files, then in debug builds any name registered
+    // this session
+    bool ResolvePath(AssetId id, std::string& path) const;
+
+    // Hot reload (inotify, Linux only): changed TGAs under directory are
+    // decoded on a background thread and swapped in by ApplyPendingReloads
+    bool StartWatching(const std::string& directory);
+    void StopWatching();
+
+    // Call between frames; fills reloaded with textures whose image changed
+    void ApplyPendingReloads(std::vector<Texture*>& reloaded);
+
+    size_t GetStackUsed() const { return m_allocator ? m_allocator->GetUsed() : 0; }
 
 private:
+    void WatchThread();
+    void QueueReload(const std::string& filepath);
+
     StackAllocator* m_allocator;
-    std::map<std::string, Asset*> m_assets;
+    AssetTable<Asset*> m_assets;
+    AssetTable<std::string> m_paths;   // Loose files, kept in release builds too
+
+    // Hot reload
+    std::thread m_watchThread;
+    std::mutex m_reloadMutex;
+    std::map<std::string, ImageInfo*> m_pendingReloads;
+    std::atomic<bool> m_reloadsPending;
+    std::map<int, std::string> m_watchDirs;
+    int m_inotifyFd;
+    int m_wakeFds[2];
 };
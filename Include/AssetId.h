@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 64-bit FNV-1a hash of an asset path or name, usable at compile time:
+//   static constexpr AssetId ROCK("Assets/Textures/rock.tga");
+// '\' hashes as '/' so Windows-style paths resolve to the same asset.
+struct AssetId {
+    uint64_t Value;
+
+    constexpr AssetId() : Value(0) {}
+    constexpr explicit AssetId(uint64_t value) : Value(value) {}
+    constexpr AssetId(const char* path) : Value(Hash(path, Length(path))) {}
+    AssetId(const std::string& path) : Value(Hash(path.data(), path.size())) {}
+
+    constexpr bool IsValid() const { return Value != 0; }
+    constexpr bool operator==(const AssetId& other) const { return Value == other.Value; }
+    constexpr bool operator!=(const AssetId& other) const { return Value != other.Value; }
+    constexpr bool operator<(const AssetId& other) const { return Value < other.Value; }
+
+    static constexpr uint64_t Hash(const char* path, size_t length) {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < length; ++i) {
+            hash ^= (unsigned char)(path[i] == '\\' ? '/' : path[i]);
+            hash *= 1099511628211ull;
+        }
+        // 0 marks an empty slot in AssetTable
+        return hash != 0 ? hash : 1;
+    }
+
+    // Debug builds remember the string behind each registered id for
+    // logs and diagnostics; release builds keep no names
+    static AssetId Register(const std::string& path);
+    bool FindName(std::string& name) const;
+    std::string GetName() const;   // Registered name, or the id in hex
+
+private:
+    static constexpr size_t Length(const char* path) {
+        size_t length = 0;
+        while (path[length] != '\0') ++length;
+        return length;
+    }
+};
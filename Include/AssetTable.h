@@ -0,0 +1,105 @@
+#pragma once
+
+#include "AssetId.h"
+#include <vector>
+
+// Open-addressing hash table keyed by AssetId (linear probing, power-of-two
+// capacity). AssetId's hash is already well mixed, so it's used directly.
+template<typename T>
+class AssetTable {
+public:
+    AssetTable(size_t initialCapacity = 64) : m_count(0) {
+        size_t capacity = 16;
+        while (capacity < initialCapacity) capacity <<= 1;
+        m_slots.resize(capacity);
+    }
+
+    T* Find(AssetId id) {
+        size_t mask = m_slots.size() - 1;
+        for (size_t i = id.Value & mask; m_slots[i].Key != 0; i = (i + 1) & mask) {
+            if (m_slots[i].Key == id.Value) {
+                return &m_slots[i].Value;
+            }
+        }
+        return nullptr;
+    }
+
+    const T* Find(AssetId id) const {
+        return const_cast<AssetTable*>(this)->Find(id);
+    }
+
+    void Insert(AssetId id, const T& value) {
+        T* existing = Find(id);
+        if (existing) {
+            *existing = value;
+            return;
+        }
+
+        // Keep the load factor at or below 1/2 so probes stay short
+        if ((m_count + 1) * 2 > m_slots.size()) {
+            Grow();
+        }
+
+        size_t mask = m_slots.size() - 1;
+        size_t i = id.Value & mask;
+        while (m_slots[i].Key != 0) i = (i + 1) & mask;
+        m_slots[i].Key = id.Value;
+        m_slots[i].Value = value;
+        m_count++;
+    }
+
+    bool Remove(AssetId id) {
+        size_t mask = m_slots.size() - 1;
+        size_t i = id.Value & mask;
+        while (m_slots[i].Key != id.Value) {
+            if (m_slots[i].Key == 0) return false;
+            i = (i + 1) & mask;
+        }
+
+        // Backward-shift later entries of the probe run into the hole
+        size_t hole = i;
+        for (size_t j = (i + 1) & mask; m_slots[j].Key != 0; j = (j + 1) & mask) {
+            size_t home = m_slots[j].Key & mask;
+            if (((j - home) & mask) >= ((j - hole) & mask)) {
+                m_slots[hole] = m_slots[j];
+                hole = j;
+            }
+        }
+        m_slots[hole] = Slot();
+        m_count--;
+        return true;
+    }
+
+    template<typename F>
+    void ForEach(F function) {
+        for (Slot& slot : m_slots) {
+            if (slot.Key != 0) function(AssetId(slot.Key), slot.Value);
+        }
+    }
+
+    void Clear() {
+        for (Slot& slot : m_slots) slot = Slot();
+        m_count = 0;
+    }
+
+    size_t GetSize() const { return m_count; }
+
+private:
+    struct Slot {
+        uint64_t Key = 0;
+        T Value = T();
+    };
+
+    void Grow() {
+        std::vector<Slot> old;
+        old.swap(m_slots);
+        m_slots.resize(old.size() * 2);
+        m_count = 0;
+        for (Slot& slot : old) {
+            if (slot.Key != 0) Insert(AssetId(slot.Key), slot.Value);
+        }
+    }
+
+    std::vector<Slot> m_slots;
+    size_t m_count;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "StandardIncludes.h"
+#include "Asset.h"
+#include <cstdint>
+
+// Runtime-ready texture written by asset_cook (.ctex beside the source
+// .tga). Pixels are already what the renderer uploads and the software
+// rasterizer draws: SDL_PIXELFORMAT_RGBA32, premultiplied alpha, top row
+// first, starting on a 64-byte boundary. Loading is a header check and,
+// from a mounted archive, no copy at all. Layout:
+//   Header | padding to DataOffset | Height rows of Pitch bytes
+class CookedTexture {
+public:
+    static const uint32_t VERSION = 1;
+    static const uint32_t DATA_ALIGNMENT = 64;
+    static const uint32_t FLAG_PREMULTIPLIED = 1;
+
+    struct Header {
+        char Magic[4];           // "CTEX"
+        uint32_t Version;
+        uint32_t Width;
+        uint32_t Height;
+        uint32_t Format;         // SDL_PixelFormat of the pixel data
+        uint32_t Flags;
+        uint32_t Pitch;          // Bytes per row
+        uint32_t DataOffset;     // Multiple of DATA_ALIGNMENT
+        uint64_t DataSize;
+    };
+
+    // "Assets/Textures/rock.tga" -> "Assets/Textures/rock.ctex"
+    static std::string GetCookedPath(const std::string& sourcePath);
+
+    // Finds a cooked copy of sourcePath that's at least as new as the
+    // source, so an edited TGA isn't masked by a stale cook
+    static bool FindCooked(const std::string& sourcePath, std::string& cookedPath);
+
+    // Converts decoded TGA pixels (ReadTGA's RGB/RGBA) to the cooked format
+    static bool Cook(const ImageInfo& image, std::vector<unsigned char>& out);
+
+    static bool ReadHeader(const std::string& filepath, int& width, int& height, int& bitsPerPixel);
+
+    // Pixels served straight from a mounted archive are Mapped (read-only,
+    // not owned); loose files are read into an owned buffer
+    static ImageInfo* Read(const std::string& filepath);
+
+private:
+    static bool Validate(const Header& header, const std::string& filepath);
+    static bool ValidateSize(const Header& header, size_t fileSize, const std::string& filepath);
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+// Instruction sets the SIMD kernels are written for, narrowest first
+enum class SimdLevel : int { SCALAR, SSE2, AVX, AVX2 };
+
+// On x86-64 the AVX and AVX2 kernels are compiled per function with
+// SIMD_TARGET, whatever the build's baseline, and picked at runtime from
+// GetSimdLevel(). One binary then runs on any x86-64 CPU and still uses the
+// wider kernels where the CPU and OS support them.
+#if defined(__x86_64__) || defined(_M_X64)
+#define SIMD_DISPATCH 1
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SIMD_TARGET(isa)   // MSVC compiles AVX intrinsics without /arch
+#endif
+#endif
+
+class CpuFeatures {
+public:
+    // The widest level this CPU and OS support; detected once
+    static SimdLevel GetSupportedSimdLevel();
+
+    // The supported level capped by SetSimdLimit; kernels dispatch on this
+    static SimdLevel GetSimdLevel();
+
+    // Keeps kernels at or below level, so benchmarks can run each path on
+    // the same machine and compare their output
+    static void SetSimdLimit(SimdLevel level);
+
+    static const char* GetSimdLevelName(SimdLevel level);
+};
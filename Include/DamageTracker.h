@@ -0,0 +1,42 @@
+#pragma once
+
+#include "StandardIncludes.h"
+
+// Tracks screen regions touched by draws across two consecutive frames.
+// A region is damaged if something was drawn there last frame (must be
+// erased) or this frame (must be drawn). Overlapping rects are merged so
+// each pixel is cleared and redrawn at most once.
+class DamageTracker {
+public:
+    DamageTracker();
+
+    void SetScreenSize(int width, int height);
+
+    // Forces the next Resolve() to return the whole screen
+    void Invalidate() { m_fullRedraw = true; }
+
+    void AddRect(const SDL_FRect& rect);
+
+    // Merges last frame's and this frame's rects into m_regions and
+    // rolls this frame's rects over to become next frame's history
+    void Resolve();
+
+    const std::vector<SDL_Rect>& GetRegions() const { return m_regions; }
+    bool IsFullRedraw() const { return m_regionsFull; }
+
+private:
+    static const size_t MAX_REGIONS = 64;
+
+    void MergeRegions();
+    static bool Overlaps(const SDL_Rect& a, const SDL_Rect& b);
+    static SDL_Rect Union(const SDL_Rect& a, const SDL_Rect& b);
+
+    int m_screenWidth;
+    int m_screenHeight;
+    bool m_fullRedraw;
+    bool m_regionsFull;
+
+    std::vector<SDL_Rect> m_previous;
+    std::vector<SDL_Rect> m_current;
+    std::vector<SDL_Rect> m_regions;
+};
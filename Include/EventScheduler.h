@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Runs callbacks at points in game time. Pending events sit in a
+// hierarchical timer wheel: each advance only visits the wheel slots the
+// clock moved through, and an event far in the future is touched just a
+// few times as it cascades down toward its slot, so the cost doesn't grow
+// with the number of events waiting. Nothing is polled between events.
+class EventScheduler {
+public:
+    typedef uint64_t EventId;   // 0 is never a valid id
+    typedef std::function<void()> Callback;
+
+    // resolution is the wheel's tick in seconds. Events still fire on the
+    // first advance that reaches their exact time; it only sets how finely
+    // pending events are bucketed.
+    explicit EventScheduler(double resolution = 1.0 / 1000.0);
+
+    // Times at or before the current time fire on the next AdvanceTo()
+    EventId At(double time, Callback callback);
+    EventId After(double delay, Callback callback) { return At(m_time + delay, std::move(callback)); }
+
+    // False if the event already fired or was cancelled
+    bool Cancel(EventId id);
+
+    // Moves the clock forward and fires every event that is now due, in
+    // time order (ties in the order they were scheduled). Callbacks may
+    // schedule and cancel events; new ones that are already due fire
+    // before this returns.
+    void AdvanceTo(double time);
+
+    double GetTime() const { return m_time; }
+    size_t GetPendingCount() const { return m_pending; }
+
+private:
+    static constexpr int LEVEL_BITS = 6;
+    static constexpr uint32_t SLOTS = 1u << LEVEL_BITS;
+    static constexpr int LEVELS = 4;   // 2^24 ticks ahead, about 4.6 hours at 1 ms
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+    static constexpr uint64_t NO_TICK = ~0ull;
+
+    struct Event {
+        double Time;
+        uint64_t Tick;
+        uint64_t Sequence;
+        uint32_t Generation;
+        uint32_t Next;   // Within a wheel slot, or the free list
+        bool Active;
+        Callback Function;
+    };
+
+    uint64_t NextOccupiedTick() const;
+    void Insert(uint32_t index);
+    void Cascade(int level);
+    uint32_t Allocate();
+    void Free(uint32_t index);
+
+    std::vector<Event> m_events;
+    uint32_t m_freeList;
+    uint32_t m_slots[LEVELS][SLOTS];
+    uint64_t m_occupied[LEVELS];   // Bit per non-empty slot
+
+    // Past the top level; re-inserted each time the top level wraps
+    std::vector<uint32_t> m_overflow;
+
+    // Reached their tick; fire once the clock reaches their exact time
+    std::vector<uint32_t> m_due;
+    std::vector<uint32_t> m_firing;
+
+    double m_resolution;
+    double m_time;
+    uint64_t m_tick;
+    uint64_t m_nextSequence;
+    size_t m_pending;
+};
@@ -2,16 +2,52 @@
 
 #include "StandardIncludes.h"
 #include "Singleton.h"
+#include "AssetArchive.h"
+#include "Log.h"
+
+// Bytes of a file: either a view into the mounted archive or, for loose
+// files, a copy held in Storage
+struct FileView {
+    const unsigned char* Data = nullptr;
+    size_t Size = 0;
+    std::vector<unsigned char> Storage;
+};
 
 class FileController : public Singleton<FileController> {
 public:
     FileController() {}
     virtual ~FileController() {}
 
+    // Files found in a mounted archive are served from its mapping;
+    // anything else falls back to the loose file on disk
+    bool MountArchive(const std::string& filepath) { return m_archive.Open(filepath); }
+    void UnmountArchive() { m_archive.Close(); }
+    bool IsArchiveMounted() const { return m_archive.IsOpen(); }
+    bool FindArchivePath(AssetId id, std::string& path) const { return m_archive.FindPath(id, path); }
+
+    // A view into the mounted archive only; never touches loose files
+    bool FindInArchive(const std::string& filepath, const unsigned char*& data, size_t& size) const {
+        return m_archive.Find(filepath, data, size);
+    }
+
+    bool OpenFile(const std::string& filepath, FileView& view) {
+        if (m_archive.Find(filepath, view.Data, view.Size)) {
+            return true;
+        }
+
+        if (!ReadFile(filepath, view.Storage)) {
+            return false;
+        }
+
+        view.Data = view.Storage.data();
+        view.Size = view.Storage.size();
+        return true;
+    }
+
     bool ReadFile(const std::string& filepath, std::vector<unsigned char>& data) {
         std::ifstream file(filepath, std::ios::binary | std::ios::ate);
         if (!file.is_open()) {
-            std::cerr << "Failed to open file: " << filepath << std::endl;
+            LOG_ERROR("Failed to open file: %s", filepath.c_str());
             return false;
         }
 
@@ -20,21 +56,43 @@ public:
 
         data.resize(static_cast<size_t>(size));
         if (!file.read(reinterpret_cast<char*>(data.data()), size)) {
-            std::cerr << "Failed to read file: " << filepath << std::endl;
+            LOG_ERROR("Failed to read file: %s", filepath.c_str());
             return false;
         }
 
         return true;
     }
 
+    // Reads just the first size bytes, e.g. a format header
+    bool ReadFileHeader(const std::string& filepath, void* data, size_t size) {
+        const unsigned char* packed;
+        size_t packedSize;
+        if (m_archive.Find(filepath, packed, packedSize)) {
+            if (packedSize < size) return false;
+            memcpy(data, packed, size);
+            return true;
+        }
+
+        std::ifstream file(filepath, std::ios::binary);
+        if (!file.is_open()) {
+            LOG_ERROR("Failed to open file: %s", filepath.c_str());
+            return false;
+        }
+
+        return (bool)file.read(reinterpret_cast<char*>(data), size);
+    }
+
     bool WriteFile(const std::string& filepath, const void* data, size_t size) {
         std::ofstream file(filepath, std::ios::binary);
         if (!file.is_open()) {
-            std::cerr << "Failed to create file: " << filepath << std::endl;
+            LOG_ERROR("Failed to create file: %s", filepath.c_str());
             return false;
         }
 
         file.write(reinterpret_cast<const char*>(data), size);
         return file.good();
     }
+
+private:
+    AssetArchive m_archive;
 };
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "StandardIncludes.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Records presented frames without stalling the render loop. Submit()
+// copies a frame into a ring of preallocated buffers and a writer thread
+// encodes and writes them; if the writer falls behind, frames are dropped
+// rather than waited for.
+class FrameCapture {
+public:
+    enum class Format {
+        TGA,   // One 32-bit TGA per frame in a directory
+        RAW    // A single stream of RGBA frames, e.g. for ffmpeg -f rawvideo
+    };
+
+    FrameCapture();
+    ~FrameCapture();
+
+    // path is a directory for TGA and a file for RAW
+    bool Start(const std::string& path, Format format, int width, int height, size_t ringSize = 4);
+
+    // Writes out frames still in the ring, then stops the writer
+    void Stop();
+
+    bool IsActive() const { return m_writer.joinable(); }
+
+    // False when the ring is full, so callers can skip reading the frame back
+    bool CanSubmit();
+
+    // Copies an RGBA32 frame; frames not of the size given to Start() are rejected
+    bool Submit(const void* pixels, int pitch, int width, int height);
+
+    size_t GetWrittenFrames() const { return m_written; }
+    size_t GetDroppedFrames() const { return m_dropped; }
+
+private:
+    struct Slot {
+        std::vector<unsigned char> Pixels;
+        size_t Frame;
+    };
+
+    void WriterThread();
+    bool WriteFrame(const Slot& slot);
+
+    std::string m_path;
+    Format m_format;
+    int m_width;
+    int m_height;
+
+    // Single producer (render thread), single consumer (writer); slots in
+    // [m_tail, m_tail + m_count) are waiting to be written
+    std::vector<Slot> m_slots;
+    size_t m_head;
+    size_t m_tail;
+    size_t m_count;
+    bool m_stopping;
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    std::thread m_writer;
+
+    std::ofstream m_stream;
+    std::vector<unsigned char> m_encoded;
+    size_t m_submitted;
+    size_t m_written;
+    size_t m_dropped;
+};
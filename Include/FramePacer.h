@@ -0,0 +1,44 @@
+#pragma once
+
+#include "StandardIncludes.h"
+
+// Holds the main loop to a target frame rate without burning a core. The
+// wait before each frame sleeps on the OS timer for most of the remaining
+// time and spins (yielding) only for the last fraction of a millisecond.
+// The sleep stops short by a margin that tracks how late the OS has been
+// waking us, so timer slack is absorbed by the spin instead of making the
+// frame late.
+class FramePacer {
+public:
+    FramePacer();
+
+    // 0 = unlimited (Wait() returns immediately)
+    void SetTargetRate(float hz);
+    float GetTargetRate() const { return m_targetRate; }
+
+    // Blocks until the next frame is due. A frame that overran starts
+    // immediately and the schedule restarts from it, so there's no burst of
+    // short frames to catch up.
+    void Wait();
+
+    // Frame start times against their deadlines, and the current sleep margin
+    void PrintStats(std::ostream& out) const;
+
+private:
+    void Sleep(Uint64 ticks);
+
+    float m_targetRate;
+    Uint64 m_period;
+    Uint64 m_nextFrame;
+    Uint64 m_spinWindow;
+    Uint64 m_sleepMargin;
+    double m_ticksPerMs;
+
+    // Frame start lateness in ms
+    int m_frames;
+    int m_missedFrames;
+    double m_jitterSum;
+    double m_jitterMax;
+    double m_waitMs;
+    double m_sleepMs;
+};
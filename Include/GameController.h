@@ -4,6 +4,15 @@
 #include "Singleton.h"
 #include "Level.h"
 #include "Renderer.h"
+#include "RenderQueue.h"
+#include "StressConfig.h"
+#include "FrameCapture.h"
+#include "PerfRecorder.h"
+#include "FramePacer.h"
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
 
 class GameController : public Singleton<GameController> {
 public:
@@ -12,24 +21,153 @@ public:
 
     void RunGame();
 
+    // Redraw only the screen regions sprites moved through each frame
+    void SetDamageTracking(bool enabled) { m_damageTracking = enabled; }
+
+    // Rasterize sprites on the CPU; headless also skips the window
+    void SetSoftwareRaster(bool enabled) { m_softwareRaster = enabled; }
+    void SetHeadless(bool enabled) { m_headless = enabled; }
+    void SetRasterThreads(unsigned int threads) { m_rasterThreads = threads; }
+
+    // Record every presented frame to path (a directory of TGAs, or one raw RGBA stream)
+    void SetCapture(const std::string& path, FrameCapture::Format format) {
+        m_capturePath = path;
+        m_captureFormat = format;
+    }
+
+    // Print per-subsystem memory use once a second and at exit
+    void SetMemoryStats(bool enabled) { m_memoryStats = enabled; }
+
+    // Watch Assets/ and swap in changed textures between frames
+    void SetHotReload(bool enabled) { m_hotReload = enabled; }
+
+    // CPU (decoded pixels) and GPU (uploaded textures) budgets in bytes; 0 = unlimited
+    void SetResidencyBudgets(size_t cpuBytes, size_t textureBytes) {
+        m_cpuBudget = cpuBytes;
+        m_textureBudget = textureBytes;
+    }
+
+    // Simulate in fixed steps of 1/hz seconds, independent of the frame
+    // rate; 0 steps once per frame with the frame's delta
+    void SetSimulationRate(float hz) { m_fixedStep = hz > 0.0f ? 1.0f / hz : 0.0f; }
+
+    // Advance game time by exactly 1/hz per frame whatever the wall clock
+    // says, for reproducible runs; 0 uses the measured frame time
+    void SetFixedFrameRate(float hz) { m_fixedFrameTime = hz > 0.0f ? 1.0f / hz : 0.0f; }
+
+    // Cap the main loop at hz, sleeping between frames; 0 = unlimited.
+    // Defaults to 60 with a window and unlimited when headless
+    void SetFrameRateLimit(float hz) { m_frameRateLimit = hz; }
+
+    // Simulate and record frame N+1 on a separate thread while the main
+    // thread draws frame N; off runs them back to back on the main thread
+    void SetPipelining(bool enabled) { m_pipelining = enabled; }
+
+    // Seeds level spawns (offset by level number) for reproducible runs; 0 = random
+    void SetRandomSeed(unsigned int seed) { m_randomSeed = seed; }
+
+    // Write frame time, allocation, memory and load numbers to reportPath
+    // and/or compare them with a baseline report; a regression past
+    // tolerance makes GetExitCode() non-zero. Times are only compared with
+    // checkTiming, against a baseline from the same machine and build.
+    void SetPerfReport(const std::string& reportPath, const std::string& baselinePath, double tolerance,
+                       bool checkTiming) {
+        m_perfReportPath = reportPath;
+        m_perfBaselinePath = baselinePath;
+        m_perfTolerance = tolerance;
+        m_perfCheckTiming = checkTiming;
+    }
+
+    int GetExitCode() const { return m_exitCode; }
+
+    // Start in StressLevel instead of Level1
+    void EnableStressTest(const StressConfig& config) {
+        m_stressTest = true;
+        m_stressConfig = config;
+    }
+
 private:
     void Initialize();
     void Update(float deltaTime);
+    void Simulate(float deltaTime);
+    void Step(float deltaTime);
+    void Record();
     void Render();
     void Shutdown();
 
+    void StartSimulation();
+    void WaitForSimulation();
+    void SimulationLoop();
+    void StopSimulationThread();
+
     void CalculateFPS(float deltaTime);
-    void RenderUI();
+    void RenderUI(FramePacket* packet);
     void HandleLevelTransition();
+    void StartPreload();
+    void PollPreload();
+    void FinishPreload();
+    void ApplyAssetReloads();
+    void FinishPerfReport();
+    void UpdateMetrics();
+    double GetElapsedMs(Uint64 start) const;
+
+    // Pools, animation state and seed for the levels below
+    World* m_world;
+    unsigned int m_randomSeed;
 
     Level* m_currentLevel;
+
+    // Next level, prepared in the background while the current one runs
+    Level* m_nextLevel;
+    std::future<double> m_nextLevelLoad;
+    std::vector<Texture*> m_nextLevelTextures;
+    bool m_nextLevelReady;
+
     Renderer* m_renderer;
+    RenderQueue m_renderQueue;
+
+    // Steps the level and records the next packet while the main thread
+    // draws the last one. Everything else the levels, pools and textures
+    // share runs on the main thread between the two.
+    bool m_pipelining;
+    std::thread m_simulationThread;
+    std::mutex m_simulationMutex;
+    std::condition_variable m_simulationWake;
+    std::condition_variable m_simulationDone;
+    bool m_simulationPending;
+    bool m_simulationStopping;
+
     SDL_Event m_event;
     bool m_running;
+    bool m_damageTracking;
+    bool m_softwareRaster;
+    bool m_headless;
+    unsigned int m_rasterThreads;
+    bool m_stressTest;
+    bool m_hotReload;
+    bool m_memoryStats;
+    size_t m_cpuBudget;
+    size_t m_textureBudget;
+    std::vector<Texture*> m_reloadedTextures;
+    StressConfig m_stressConfig;
+    std::string m_capturePath;
+    FrameCapture::Format m_captureFormat;
+    FrameCapture m_capture;
+    PerfRecorder m_perf;
+    FramePacer m_pacer;
+    float m_frameRateLimit;
+    std::string m_perfReportPath;
+    std::string m_perfBaselinePath;
+    double m_perfTolerance;
+    bool m_perfCheckTiming;
+    int m_exitCode;
 
     // Timing
     Uint64 m_lastTime;
     float m_deltaTime;
+    float m_fixedStep;
+    float m_fixedFrameTime;
+    float m_stepAccumulator;
     float m_fps;
     int m_frameCount;
     float m_fpsTimer;
@@ -3,8 +3,20 @@
 #include "StandardIncludes.h"
 #include "Resource.h"
 #include "Warrior.h"
+#include "Rock.h"
+#include "World.h"
+#include "EventScheduler.h"
+#include "Task.h"
 
-class Renderer;
+class FramePacket;
+
+// What a level needs before it starts, declared so it can be prepared
+// while the previous level is still running
+struct LevelRequirements {
+    std::vector<AssetId> Clips;   // Animation clips whose sheets get decoded and uploaded
+    size_t Warriors = 0;          // New entities taken from the pools in Initialize()
+    size_t Rocks = 0;
+};
 
 class Level : public Resource {
 public:
@@ -12,15 +24,40 @@ public:
     virtual ~Level();
 
     virtual void Initialize() = 0;
+    // With pipelined frames these run on the simulation thread; Render()
+    // only records draws, for the render thread to make later
     virtual void Update(float deltaTime) = 0;
-    virtual void Render(Renderer* renderer) = 0;
+    virtual void Render(FramePacket* packet) = 0;
+    // Flags set by the level's tasks as things happen, so they're cheap to
+    // check after every step
     virtual bool ShouldTransition() const = 0;
     virtual bool ShouldQuit() const = 0;
 
+    // The level that follows this one, constructed but not initialized
+    virtual Level* CreateNextLevel() const { return nullptr; }
+    virtual void GetRequirements(LevelRequirements& /*requirements*/) const {}
+
+    // Runs on a loader thread before Initialize(); must not touch the
+    // pools or other main-thread state
+    virtual void Preload() {}
+
+    // Carries the previous level's warriors over at a transition
+    void TakeWarriors(Level* previous) {
+        m_warriors.swap(previous->m_warriors);
+        m_warriorsChanged.Notify();
+    }
+
+    // Called once the level becomes the one being updated: right after
+    // Initialize() for the first level, after TakeWarriors() at a
+    // transition. Every entity in the world moves from then on, so a level
+    // prepared ahead of time spawns moving entities here.
+    virtual void Start() {}
+
     void SaveToFile(const std::string& filename);
     static Level* LoadFromFile(const std::string& filename, int levelNumber);
 
     int GetLevelNumber() const { return m_levelNumber; }
+    World* GetWorld() const { return m_world; }
     float GetGameTime() const { return m_gameTime; }
     bool IsAutoSaved() const { return m_autoSaved; }
     SDL_Color GetBackgroundColor() const { return m_backgroundColor; }
@@ -30,9 +67,78 @@ public:
     virtual void Deserialize(std::istream& stream) override;
 
 protected:
+    // Game time at which Level 1 and Level 2 save themselves
+    static constexpr float AUTOSAVE_TIME = 5.0f;
+
+    // A warrior past this has left the screen
+    static constexpr float EXIT_X = 1920.0f;
+
+    // Seeded from the world's seed offset by level number, or randomly
+    std::mt19937 CreateRandomGenerator() const;
+
+    // Moves game time forward and runs the level's events and tasks that
+    // are now due
+    void AdvanceTime(float deltaTime);
+
+    // Runs task on the level's game time until it ends or the level is
+    // destroyed
+    void StartTask(Task task);
+
+    // Saves the level at AUTOSAVE_TIME if the world autosaves
+    Task RunAutoSave();
+    virtual void AutoSave() {}
+
+    // Sets m_leadExited once the first warrior has left the screen. World
+    // transforms must be current whenever it starts or m_warriorsChanged
+    // is notified.
+    Task WatchLeadWarrior();
+
+    struct Contact {
+        float Time;   // Seconds into the step when the boxes first touch
+        Warrior* Target;
+        Rock* Hit;
+    };
+
+    // Swept AABB test over the step that just moved both entities to their
+    // current positions; true if they touch, with the earliest contact time
+    static bool SweepAABB(Warrior* w, Rock* r, float deltaTime, float& timeOfImpact);
+
+    // Applies contacts in time order; each warrior and rock collides at most once
+    static void ResolveContacts(std::vector<Contact>& contacts);
+
+    // Returns entities matching done to their pool and drops them from the
+    // list, keeping the rest in order
+    template<typename T, typename Predicate>
+    static void ReleaseWhere(std::vector<T*>& entities, ObjectPool<T>* pool, Predicate done) {
+        size_t kept = 0;
+        for (T* entity : entities) {
+            if (done(entity)) {
+                pool->ReturnResource(entity);
+            } else {
+                entities[kept++] = entity;
+            }
+        }
+        entities.resize(kept);
+    }
+
+    template<typename T>
+    static void ReleaseAll(std::vector<T*>& entities, ObjectPool<T>* pool) {
+        if (pool) {
+            ReleaseWhere(entities, pool, [](T*) { return true; });
+        }
+        entities.clear();
+    }
+
+    // The world current when the level was constructed; its pools, seed
+    // and animation system serve the level for its whole life
+    World* m_world;
+    EventScheduler m_events;   // On game time
+    TaskSignal m_warriorsChanged;   // Warriors taken over or released, or the first one exited
+    std::vector<Task> m_tasks;   // After what they wait on, so destroyed first
     int m_levelNumber;
     float m_gameTime;
     bool m_autoSaved;
+    bool m_leadExited;
     SDL_Color m_backgroundColor;
     std::vector<Warrior*> m_warriors;
 };
@@ -8,14 +8,16 @@ public:
     virtual ~Level1();
 
     virtual void Initialize() override;
+    virtual void Start() override;
     virtual void Update(float deltaTime) override;
-    virtual void Render(Renderer* renderer) override;
-    virtual bool ShouldTransition() const override;
+    virtual void Render(FramePacket* packet) override;
+    virtual bool ShouldTransition() const override { return m_leadExited; }
     virtual bool ShouldQuit() const override { return false; }
+    virtual Level* CreateNextLevel() const override;
 
     virtual void Serialize(std::ostream& stream) override;
     virtual void Deserialize(std::istream& stream) override;
 
 private:
-    void CheckAutoSave();
+    virtual void AutoSave() override;
 };
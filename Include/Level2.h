@@ -1,26 +1,41 @@
 #pragma once
 
 #include "Level.h"
-#include "Rock.h"
 
 class Level2 : public Level {
 public:
-    Level2(std::vector<Warrior*> warriors);
+    Level2();
     virtual ~Level2();
 
     virtual void Initialize() override;
+    virtual void Start() override;
     virtual void Update(float deltaTime) override;
-    virtual void Render(Renderer* renderer) override;
+    virtual void Render(FramePacket* packet) override;
     virtual bool ShouldTransition() const override { return false; }
-    virtual bool ShouldQuit() const override;
+    virtual bool ShouldQuit() const override { return m_finished; }
+
+    virtual void GetRequirements(LevelRequirements& requirements) const override;
+    virtual void Preload() override;
 
     virtual void Serialize(std::ostream& stream) override;
     virtual void Deserialize(std::istream& stream) override;
 
 private:
+    // Microbenchmarks drive collision checks directly
+    friend class LevelBench;
+
+    static const int ROCK_COUNT = 10;
+
+    struct RockSpawn {
+        float X, Y, Speed, AnimSpeed;
+    };
+
     std::vector<Rock*> m_rocks;
+    std::vector<RockSpawn> m_rockSpawns;
+    std::vector<Contact> m_contacts;
+    bool m_finished;   // Set by WatchForEnd()
 
-    void CheckAutoSave();
-    void CheckCollisions();
-    bool CheckAABBCollision(Warrior* w, Rock* r);
+    virtual void AutoSave() override;
+    Task WatchForEnd();
+    void CheckCollisions(float deltaTime);
 };
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdarg>
+#include <string>
+
+enum class LogLevel : int {
+    DEBUG,
+    INFO,
+    WARN,
+    ERR     // Not ERROR: windows.h defines that as a macro
+};
+
+// Messages below this level are compiled out: 0 = debug, 1 = info,
+// 2 = warning, 3 = error only
+#ifndef LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define LOG_COMPILE_LEVEL 1
+#else
+#define LOG_COMPILE_LEVEL 0
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LOG_PRINTF_FORMAT(fmt, args) __attribute__((format(printf, fmt, args)))
+#else
+#define LOG_PRINTF_FORMAT(fmt, args)
+#endif
+
+// Asynchronous logging. Each thread formats its messages into its own
+// lock-free ring buffer and a sink thread writes them out, so logging costs
+// a vsnprintf and never waits on I/O or another thread. A thread whose ring
+// is full drops the message and the sink reports how many were lost.
+// Before Start() (and after Stop()) messages are written synchronously,
+// which is what the tools rely on.
+class Log {
+public:
+    // Empty path: info and debug go to stdout, warnings and errors to stderr
+    // as plain lines. A file gets every message with a timestamp and level.
+    static bool Start(const std::string& filepath = "");
+
+    // Writes out everything still buffered and joins the sink thread
+    static void Stop();
+
+    // Blocks until everything logged so far has been written; for reports
+    // printed straight to stdout that must come after the log
+    static void Flush();
+
+    // Runtime filter on top of LOG_COMPILE_LEVEL
+    static void SetLevel(LogLevel level);
+    static LogLevel GetLevel();
+    static bool ParseLevel(const std::string& name, LogLevel& level);
+
+    static void Write(LogLevel level, const char* format, ...) LOG_PRINTF_FORMAT(2, 3);
+    static void WriteV(LogLevel level, const char* format, va_list args);
+};
+
+#if LOG_COMPILE_LEVEL <= 0
+#define LOG_DEBUG(...) Log::Write(LogLevel::DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= 1
+#define LOG_INFO(...) Log::Write(LogLevel::INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= 2
+#define LOG_WARN(...) Log::Write(LogLevel::WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#define LOG_ERROR(...) Log::Write(LogLevel::ERR, __VA_ARGS__)
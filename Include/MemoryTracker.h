@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+// Subsystems that heap memory is charged to
+enum class MemoryTag : uint8_t {
+    UNTAGGED,    // Process-lifetime state and anything outside a MemoryScope
+    ASSETS,
+    TEXTURES,    // Decoded pixel data
+    POOLS,
+    LEVELS,
+    RENDERER,
+    TRANSIENT,   // Per-frame scratch
+    COUNT
+};
+
+struct MemoryStats {
+    size_t CurrentBytes;
+    size_t PeakBytes;
+    size_t LiveAllocations;
+    size_t FrameAllocations;   // During the last completed frame
+    size_t FrameBytes;
+};
+
+// Allocation accounting by subsystem. Global operator new charges the
+// calling thread's current tag (see MemoryScope); allocators that take
+// memory straight from malloc record it themselves. Counters are atomic,
+// so any thread may allocate.
+class MemoryTracker {
+public:
+    static void RecordAlloc(MemoryTag tag, size_t bytes);
+    static void RecordFree(MemoryTag tag, size_t bytes);
+
+    // One allocation that grows or shrinks in place; 0 bytes = not allocated
+    static void RecordResize(MemoryTag tag, size_t oldBytes, size_t newBytes);
+
+    static MemoryTag GetThreadTag();
+    static void SetThreadTag(MemoryTag tag);
+
+    static MemoryStats GetStats(MemoryTag tag);
+
+    // Across all tags; the peak is of the total, not a sum of per-tag peaks
+    static size_t GetTotalBytes();
+    static size_t GetTotalPeakBytes();
+    static const char* GetTagName(MemoryTag tag);
+
+    // Closes the frame's allocation counts; call once per frame
+    static void EndFrame();
+
+    static void PrintStats(std::ostream& stream);
+
+    // Prints tagged memory that is still allocated; call after teardown.
+    // Untagged memory is expected to outlive it and isn't reported.
+    static bool ReportLeaks(std::ostream& stream);
+};
+
+// Charges heap allocations on this thread to tag for the lifetime of the scope
+class MemoryScope {
+public:
+    explicit MemoryScope(MemoryTag tag) : m_previous(MemoryTracker::GetThreadTag()) {
+        MemoryTracker::SetThreadTag(tag);
+    }
+    ~MemoryScope() { MemoryTracker::SetThreadTag(m_previous); }
+
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+
+private:
+    MemoryTag m_previous;
+};
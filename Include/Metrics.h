@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Runtime values exported for dashboards. Counters only go up (totals
+// since startup); gauges hold the latest value.
+enum class Metric : uint8_t {
+    // Counters
+    FRAMES,
+    DRAW_CALLS,
+    COLLISION_TESTS,      // Warrior/rock pairs swept
+    COLLISION_HITS,
+    SAVE_BYTES,           // Written by level autosaves
+
+    // Gauges, sampled once a frame by the game
+    WARRIORS,             // Checked out of the pool
+    WARRIORS_ALIVE,
+    ROCKS,
+    WARRIOR_POOL_TOTAL,
+    WARRIOR_POOL_AVAILABLE,
+    ROCK_POOL_TOTAL,
+    ROCK_POOL_AVAILABLE,
+    ASSET_STACK_USED,     // Bytes of the asset StackAllocator in use
+    TEXTURES,             // Registered with the ResidencyManager
+    TEXTURE_CPU_BYTES,    // Decoded pixels
+    TEXTURE_GPU_BYTES,    // Uploaded textures
+    COUNT
+};
+
+// Updates are relaxed atomics, so any thread may update any metric and
+// the exporter thread reads them without locking. A snapshot isn't taken
+// atomically across metrics.
+class Metrics {
+public:
+    static void Add(Metric metric, uint64_t amount = 1) {
+        s_values[(size_t)metric].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    static void Set(Metric metric, uint64_t value) {
+        s_values[(size_t)metric].store(value, std::memory_order_relaxed);
+    }
+
+    static uint64_t Get(Metric metric) {
+        return s_values[(size_t)metric].load(std::memory_order_relaxed);
+    }
+
+    static const char* GetName(Metric metric);
+    static bool IsCounter(Metric metric) { return metric < Metric::WARRIORS; }
+
+private:
+    static std::atomic<uint64_t> s_values[(size_t)Metric::COUNT];
+};
+
+// Writes a snapshot of every metric at a fixed interval from a background
+// thread, and a last one on Stop(). Targets:
+//   <file>.csv        a header row, then one row per snapshot
+//   <file>            any other path gets one JSON object per line
+//   unix:<path>       JSON lines sent to a listening Unix-domain stream
+//                     socket; snapshots are dropped while nothing listens
+class MetricsExporter {
+public:
+    MetricsExporter();
+    ~MetricsExporter();
+
+    bool Start(const std::string& target, int intervalMs);
+    void Stop();
+
+private:
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    void ExportLoop();
+    void Export();
+    size_t FormatSnapshot(char* text, size_t size) const;
+
+    bool Connect();
+    void Disconnect();
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping;
+
+    bool m_csv;
+    FILE* m_file;
+    std::string m_socketPath;
+    int m_socket;
+    std::chrono::milliseconds m_interval;
+    std::chrono::steady_clock::time_point m_startTime;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "TransformSystem.h"
+
+// Velocities of a world's warriors and rocks, packed into flat arrays so
+// one pass moves every entity. Each instance drives a node of a
+// TransformSystem that is a direct child of one parent node (the world's
+// root): the pass moves the nodes' local positions and writes their world
+// transforms in place, so moving entities never go through the
+// transform system's dirty queues.
+class MotionSystem {
+public:
+    MotionSystem(TransformSystem* transforms, int parent)
+        : m_transforms(transforms), m_parent(parent) {}
+
+    // Sizes storage for instances on the first count nodes
+    void Reserve(size_t count);
+
+    // node must be a child of the parent given at construction and stay
+    // one while it's driven; the instance handle is the node
+    int CreateInstance(int node);
+    void ReleaseInstance(int instance);
+
+    void SetPosition(int instance, float x, float y) { m_transforms->SetLocalPosition(instance, x, y); }
+
+    void SetVelocity(int instance, float x, float y) {
+        m_velocityX[instance] = x;
+        m_velocityY[instance] = y;
+    }
+
+    // Stopped instances keep their velocity but stay where they are
+    void SetMoving(int instance, bool moving) { m_moving[instance] = moving ? ~0u : 0u; }
+    bool IsMoving(int instance) const { return m_moving[instance] != 0; }
+
+    // Local position, in the parent's space
+    float GetX(int instance) const { return m_transforms->m_localX[instance]; }
+    float GetY(int instance) const { return m_transforms->m_localY[instance]; }
+
+    // Moves every moving instance by its velocity times deltaTime and
+    // places every instance under the parent's world transform, several at
+    // a time with AVX when the CPU has it (see CpuFeatures) or SSE2. The
+    // per-instance work is a few multiply-adds, so large worlds are limited
+    // by memory bandwidth.
+    // Only the children of moved nodes are queued with the transform
+    // system, so run its Update() before reading world transforms.
+    void Update(float deltaTime);
+
+    // One instance at a time with branches; Update() gives the same
+    // results bit for bit
+    void UpdateReference(float deltaTime);
+
+    size_t GetInstanceCount() const { return m_velocityX.size(); }
+
+private:
+    // Queues the subtrees hanging off moved instances
+    void MarkMovedChildren();
+
+    TransformSystem* m_transforms;
+    int m_parent;
+
+    // Indexed by node; nodes that aren't instances are neither moving nor driven
+    std::vector<float> m_velocityX;
+    std::vector<float> m_velocityY;
+    std::vector<uint32_t> m_moving;   // All ones or zero, so they double as lane masks
+    std::vector<uint32_t> m_driven;
+};
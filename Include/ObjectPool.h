@@ -2,11 +2,14 @@
 
 #include <vector>
 #include <queue>
+#include "MemoryTracker.h"
+#include "Log.h"
 
 template<typename T>
 class ObjectPool {
 public:
-    ObjectPool(size_t initialSize = 10) {
+    ObjectPool(size_t initialSize = 10, const char* name = "ObjectPool") : m_name(name) {
+        MemoryScope scope(MemoryTag::POOLS);
         for (size_t i = 0; i < initialSize; ++i) {
             T* obj = new T();
             m_availableObjects.push(obj);
@@ -15,6 +18,12 @@ public:
     }
 
     ~ObjectPool() {
+        // Objects still checked out were dropped by their owner without being returned
+        size_t outstanding = m_allObjects.size() - m_availableObjects.size();
+        if (outstanding > 0) {
+            LOG_WARN("Pool leak: %zu of %zu %s objects never returned", outstanding, m_allObjects.size(), m_name);
+        }
+
         for (T* obj : m_allObjects) {
             delete obj;
         }
@@ -24,6 +33,7 @@ public:
     T* GetResource() {
         if (m_availableObjects.empty()) {
             // Grow pool if needed
+            MemoryScope scope(MemoryTag::POOLS);
             T* obj = new T();
             m_allObjects.push_back(obj);
             return obj;
@@ -34,8 +44,19 @@ public:
         return obj;
     }
 
+    // Grows the pool ahead of time so GetResource() doesn't allocate later
+    void Reserve(size_t count) {
+        MemoryScope scope(MemoryTag::POOLS);
+        while (m_availableObjects.size() < count) {
+            T* obj = new T();
+            m_availableObjects.push(obj);
+            m_allObjects.push_back(obj);
+        }
+    }
+
     void ReturnResource(T* obj) {
         if (obj != nullptr) {
+            MemoryScope scope(MemoryTag::POOLS);
             m_availableObjects.push(obj);
         }
     }
@@ -44,6 +65,7 @@ public:
     size_t GetAvailableSize() const { return m_availableObjects.size(); }
 
 private:
+    const char* m_name;
     std::vector<T*> m_allObjects;
     std::queue<T*> m_availableObjects;
 };
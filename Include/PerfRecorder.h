@@ -0,0 +1,36 @@
+#pragma once
+
+#include "StandardIncludes.h"
+
+// Collects a run's performance numbers for regression checks: frame time
+// percentiles, heap allocations per frame, peak heap use and load times.
+// Reports are flat JSON so a run can be checked in as a baseline and later
+// runs compared against it.
+class PerfRecorder {
+public:
+    PerfRecorder();
+
+    void BeginFrame();
+    // Call after MemoryTracker::EndFrame() so the frame's allocations are final
+    void EndFrame();
+
+    void RecordLoad(const std::string& name, double milliseconds);
+
+    bool WriteReport(const std::string& filepath) const;
+
+    // Fails when a metric is worse than the baseline by more than tolerance
+    // (0.25 = 25%); all metrics are lower-is-better. Frame and load times
+    // (the *_ms metrics) are only compared with checkTiming, since they
+    // depend on the machine and build type; allocations and peak heap
+    // don't.
+    bool CheckBaseline(const std::string& filepath, double tolerance, bool checkTiming) const;
+
+private:
+    void ComputeMetrics(std::vector<std::pair<std::string, double>>& metrics) const;
+    static bool ParseMetrics(const std::string& json, std::vector<std::pair<std::string, double>>& metrics);
+
+    Uint64 m_frameStart;
+    std::vector<float> m_frameMs;
+    std::vector<size_t> m_frameAllocations;
+    std::vector<std::pair<std::string, double>> m_loads;
+};
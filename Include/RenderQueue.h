@@ -0,0 +1,72 @@
+#pragma once
+
+#include "StandardIncludes.h"
+
+class Texture;
+
+// One recorded draw. Handle is only a reference to the texture: it's bound
+// (and uploaded if need be) when the packet is drawn. With no handle it is
+// an outline rect in Color.
+struct RenderCommand {
+    Texture* Handle;
+    SDL_FRect Src;
+    SDL_FRect Dest;
+    SDL_Color Color;
+};
+
+// Everything needed to draw one frame. Recording makes no SDL calls, so
+// the simulation can fill a packet on its own thread while the render
+// thread draws the previous one.
+class FramePacket {
+public:
+    FramePacket();
+
+    // Starts a new frame; keeps the command storage for reuse
+    void Reset(SDL_Color clearColor);
+
+    // Frees the command storage
+    void Release() { std::vector<RenderCommand>().swap(m_commands); }
+
+    void RenderTexture(Texture* texture, float x, float y, float scale = 1.0f);
+    void RenderAnimatedTexture(Texture* texture, const SDL_FRect& srcRect,
+                               float x, float y, float scale);
+    void RenderText(const std::string& text, int x, int y, SDL_Color color);
+
+    SDL_Color GetClearColor() const { return m_clearColor; }
+    const std::vector<RenderCommand>& GetCommands() const { return m_commands; }
+
+private:
+    SDL_Color m_clearColor;
+    std::vector<RenderCommand> m_commands;
+};
+
+// Double-buffered packets between the simulation and render threads: one
+// is recorded while the other is drawn. Neither side locks; the owner
+// calls Swap() at the frame boundary, once both are done with theirs.
+class RenderQueue {
+public:
+    RenderQueue() : m_record(0), m_recorded(false) {}
+
+    FramePacket* GetRecordPacket() { return &m_packets[m_record]; }
+
+    // Nullptr until the first packet has been recorded
+    const FramePacket* GetDrawPacket() const { return m_recorded ? &m_packets[1 - m_record] : nullptr; }
+
+    // The packet just recorded becomes the one to draw
+    void Swap() {
+        m_record = 1 - m_record;
+        m_recorded = true;
+    }
+
+    // Drops both packets and frees their storage
+    void Clear() {
+        m_packets[0].Release();
+        m_packets[1].Release();
+        m_recorded = false;
+    }
+
+private:
+    FramePacket m_packets[2];
+    int m_record;
+    bool m_recorded;
+};
@@ -3,13 +3,35 @@
 #include "StandardIncludes.h"
 #include "Singleton.h"
 #include "Texture.h"
+#include "DamageTracker.h"
+#include "SoftwareRasterizer.h"
+#include "FrameCapture.h"
+#include "RenderQueue.h"
 #include <map>
 
+// All SDL rendering goes through here, on the render (main) thread only
 class Renderer : public Singleton<Renderer> {
 public:
     Renderer();
     virtual ~Renderer();
 
+    // Must be called before Initialize(); switches to a software renderer
+    // that only clears, redraws and presents the damaged screen regions
+    void SetDamageTracking(bool enabled) { m_damageTracking = enabled; }
+    bool IsDamageTracking() const { return m_damageTracking; }
+
+    // Must be called before Initialize(); draws sprites on the CPU into an
+    // in-memory framebuffer instead of through an SDL renderer. Headless
+    // implies the software rasterizer and opens no window at all.
+    void SetSoftwareRaster(bool enabled) { m_softwareRaster = enabled; }
+    void SetHeadless(bool enabled) { m_headless = enabled; m_softwareRaster = m_softwareRaster || enabled; }
+    bool IsSoftwareRaster() const { return m_softwareRaster; }
+    void SetRasterThreads(unsigned int threads) { m_rasterThreads = threads; }  // 0 = one per core
+    const SoftwareRasterizer& GetRasterizer() const { return m_raster; }
+
+    // Hands every presented frame to capture (nullptr to stop)
+    void SetCapture(FrameCapture* capture) { m_capture = capture; }
+
     bool Initialize(const char* title, int width, int height);
     void Shutdown();
 
@@ -17,18 +39,66 @@ public:
     void ClearWithColor(SDL_Color color);
     void Present();
 
-    void RenderTexture(Texture* texture, float x, float y, float scale = 1.0f);
-    void RenderAnimatedTexture(Texture* texture, int frame, int totalFrames,
-                               float x, float y, float scale);
-    void RenderText(const std::string& text, int x, int y, SDL_Color color);
+    // Clears, draws the packet's commands in order and presents
+    void RenderPacket(const FramePacket& packet);
 
     SDL_Renderer* GetSDLRenderer() { return m_renderer; }
     SDL_Texture* GetSDLTexture(Texture* texture);
+    const RasterImage* GetRasterImage(Texture* texture);
+
+    // Uploads a texture for whichever backend is active
+    bool UploadTexture(Texture* texture);
+
+    // Re-uploads a cached texture after its pixels changed in place
+    void RefreshTexture(Texture* texture);
+
+    // Residency: uploaded texture memory and eviction
+    bool HasUploadedTexture(Texture* texture) const {
+        return m_textureCache.count(texture) != 0 || m_rasterCache.count(texture) != 0;
+    }
+    void ReleaseUploadedTexture(Texture* texture);
+    size_t GetTextureBytes() const { return m_textureBytes; }
 
 private:
+    // A draw recorded for replay; with neither Texture nor Image set it is
+    // an outline rect in Color
+    struct DeferredDraw {
+        SDL_Texture* Texture;
+        const RasterImage* Image;
+        SDL_FRect Src;
+        SDL_FRect Dest;
+        SDL_Color Color;
+    };
+
     SDL_Window* m_window;
     SDL_Renderer* m_renderer;
     std::map<Texture*, SDL_Texture*> m_textureCache;
+    size_t m_textureBytes;
+    size_t m_frameDraws;   // Submitted since the last Present()
+
+    // Damage tracking
+    bool m_damageTracking;
+    SDL_Color m_clearColor;
+    DamageTracker m_damage;
+    std::vector<DeferredDraw> m_deferredDraws;
+
+    // Software rasterizer
+    bool m_softwareRaster;
+    bool m_headless;
+    unsigned int m_rasterThreads;
+    SoftwareRasterizer m_raster;
+    std::vector<RasterDraw> m_rasterDraws;
+    std::map<Texture*, RasterImage*> m_rasterCache;
+    SDL_Surface* m_frameSurface;
+
+    FrameCapture* m_capture;
 
     void CreateSDLTexture(Texture* texture);
+    bool BindTexture(Texture* texture, DeferredDraw& draw);
+    static size_t GetUploadedSize(SDL_Texture* sdlTexture);
+    void Submit(const DeferredDraw& draw);
+    void Draw(const DeferredDraw& draw);
+    void PresentDamage();
+    void PresentRaster();
+    void CaptureFrame();
 };
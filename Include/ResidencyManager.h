@@ -0,0 +1,54 @@
+#pragma once
+
+#include "StandardIncludes.h"
+#include "Singleton.h"
+#include "Asset.h"
+#include <map>
+#include <future>
+
+class Texture;
+class Renderer;
+
+// Keeps decoded texture pixels (CPU) and uploaded SDL textures within
+// their memory budgets. Textures decode on first use and the least
+// recently used ones are evicted at the end of a frame when over budget.
+class ResidencyManager : public Singleton<ResidencyManager> {
+public:
+    ResidencyManager();
+    virtual ~ResidencyManager();
+
+    // Budgets in bytes; 0 means unlimited
+    void SetBudgets(size_t cpuBytes, size_t textureBytes);
+
+    void Register(Texture* texture);
+    void Unregister(Texture* texture);
+    const std::vector<Texture*>& GetTextures() const { return m_textures; }
+
+    // Advances the frame counter and installs finished prefetches
+    void BeginFrame();
+    Uint64 GetFrame() const { return m_frame; }
+
+    // Hint that a texture will be needed soon; decodes it in the background
+    void Prefetch(Texture* texture);
+
+    // Pixels for a texture that isn't resident, waiting on a prefetch if one is running
+    ImageInfo* Decode(Texture* texture);
+
+    void AdjustCpuBytes(long long delta) { m_cpuBytes += delta; }
+    size_t GetCpuBytes() const { return (size_t)m_cpuBytes; }
+
+    // Call after presenting, so nothing drawn this frame is evicted
+    void EnforceBudgets(Renderer* renderer);
+
+private:
+    void GatherEvictionCandidates(std::vector<Texture*>& candidates, bool uploaded, Renderer* renderer);
+
+    std::vector<Texture*> m_textures;
+    std::map<Texture*, std::future<ImageInfo*>> m_prefetches;
+    std::vector<Texture*> m_candidates;
+
+    Uint64 m_frame;
+    long long m_cpuBytes;
+    size_t m_cpuBudget;
+    size_t m_textureBudget;
+};
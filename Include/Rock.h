@@ -2,44 +2,58 @@
 
 #include "StandardIncludes.h"
 #include "Resource.h"
-#include "Texture.h"
 #include "ObjectPool.h"
+#include "AnimationSystem.h"
+#include "MotionSystem.h"
+#include "TransformSystem.h"
 
-class Renderer;
+class FramePacket;
 
 class Rock : public Resource {
 public:
+    static constexpr AssetId CLIP = AssetId("rock");
+
     Rock();
     virtual ~Rock();
 
+    // Moves by the world's MotionSystem while active
     void Initialize(float x, float y, float speed, float animSpeed, float scale);
-    void Update(float deltaTime);
-    void Render(Renderer* renderer);
+    void Render(FramePacket* packet);
 
     bool IsActive() const { return m_active; }
-    void SetActive(bool active) { m_active = active; }
-    bool IsOffScreen() const { return m_y > 1080.0f; }
+    void SetActive(bool active);
+    bool IsOffScreen() const { return GetY() > 1080.0f; }
 
-    float GetX() const { return m_x; }
-    float GetY() const { return m_y; }
-    float GetWidth() const { return 64.0f * m_scale; }
-    float GetHeight() const { return 64.0f * m_scale; }
+    // World space, from the cached transform of the entity's node
+    float GetX() const { return m_transformSystem->GetWorld(m_transform).X; }
+    float GetY() const { return m_transformSystem->GetWorld(m_transform).Y; }
+    float GetWidth() const { return 64.0f * m_transformSystem->GetWorld(m_transform).Scale; }
+    float GetHeight() const { return 64.0f * m_transformSystem->GetWorld(m_transform).Scale; }
+    float GetVelocityY() const { return m_active ? m_speed * GetParentScale() : 0.0f; }
 
     virtual void Serialize(std::ostream& stream) override;
     virtual void Deserialize(std::istream& stream) override;
 
-    static ObjectPool<Rock>* Pool;
-
 private:
-    static const int FRAMES = 4;
+    void BindWorld();
+
+    // Velocities are in the parent's space
+    float GetParentScale() const {
+        int parent = m_transformSystem->GetParent(m_transform);
+        return parent >= 0 ? m_transformSystem->GetWorld(parent).Scale : 1.0f;
+    }
 
-    float m_x, m_y;
     float m_speed;
     float m_scale;
     float m_animSpeed;
-    float m_animTimer;
-    int m_currentFrame;
     bool m_active;
 
-    Texture* m_texture;
+    // Playback, position and placement belong to the world that first
+    // spawned this rock; the motion instance drives the node's local position
+    AnimationSystem* m_animationSystem;
+    MotionSystem* m_motionSystem;
+    TransformSystem* m_transformSystem;
+    int m_animation;
+    int m_motion;
+    int m_transform;
 };
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "StandardIncludes.h"
+
+struct FarmConfig {
+    int Worlds = 64;
+    unsigned int Threads = 0;      // 0 = one per core
+    unsigned int Seed = 0;         // World i uses Seed + i * SEED_STRIDE; 0 = random base
+    float StepRate = 60.0f;        // Fixed simulation steps per second of game time
+    float TimeLimit = 300.0f;      // Game seconds before a world is abandoned
+};
+
+// Outcome of one Level1 -> Level2 run
+struct WorldResult {
+    unsigned int Seed = 0;
+    int Warriors = 0;
+    int Survivors = 0;             // Still running when Level 2 ended
+    float Level1Seconds = 0.0f;
+    float Level2Seconds = 0.0f;
+    double WallMs = 0.0;
+    bool Finished = false;         // False if TimeLimit ran out first
+};
+
+// Runs many independent Level1 -> Level2 simulations in one process, for
+// balancing runs. Each world gets its own pools, animation state and seed
+// and is stepped start to finish by one worker thread with no window or
+// renderer. Results depend only on the seed, not on the thread count.
+class SimulationFarm {
+public:
+    // Seeds of neighbouring worlds are this far apart, so the per-level
+    // seed offsets never overlap
+    static const unsigned int SEED_STRIDE = 16;
+
+    explicit SimulationFarm(const FarmConfig& config);
+
+    // Loads the shared clip library, runs every world and tears down again
+    bool Run();
+
+    const std::vector<WorldResult>& GetResults() const { return m_results; }
+
+    // Survival counts, level durations and per-world timings
+    void PrintSummary(std::ostream& out) const;
+
+private:
+    WorldResult RunWorld(unsigned int seed) const;
+
+    FarmConfig m_config;
+    unsigned int m_baseSeed;
+    unsigned int m_threadCount;
+    double m_wallMs;
+    std::vector<WorldResult> m_results;
+};
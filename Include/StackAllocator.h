@@ -2,42 +2,40 @@
 
 #include <cstddef>
 #include <cstdlib>
+#include "MemoryTracker.h"
 
+// Linear allocator over a reserved range of address space. Only the
+// reservation is made up front; pages are committed as allocations reach
+// them, so a large reserve costs no memory until it's used and addresses
+// never move as it grows. Clear() rewinds and hands the pages back to the OS.
 class StackAllocator {
 public:
-    StackAllocator(size_t size) : m_size(size), m_used(0) {
-        m_memory = malloc(size);
-        m_current = m_memory;
-    }
-
-    ~StackAllocator() {
-        if (m_memory) {
-            free(m_memory);
-        }
-    }
-
-    void* Allocate(size_t size) {
-        if (m_used + size > m_size) {
-            return nullptr; // Out of memory
-        }
-
-        void* result = m_current;
-        m_current = static_cast<char*>(m_current) + size;
-        m_used += size;
-        return result;
-    }
-
-    void Clear() {
-        m_used = 0;
-        m_current = m_memory;
-    }
+    // hugePages asks for transparent huge pages (Linux) over the range,
+    // which suits large, long-lived regions such as loaded assets
+    StackAllocator(size_t reserveSize, MemoryTag tag = MemoryTag::UNTAGGED, bool hugePages = false);
+    ~StackAllocator();
+
+    StackAllocator(const StackAllocator&) = delete;
+    StackAllocator& operator=(const StackAllocator&) = delete;
+
+    // Allocations are aligned for any fundamental type; nullptr once the
+    // reserve is exhausted or the OS refuses to commit more
+    void* Allocate(size_t size);
+
+    void Clear();
 
     size_t GetUsed() const { return m_used; }
     size_t GetSize() const { return m_size; }
+    size_t GetCommitted() const { return m_committed; }
 
 private:
-    void* m_memory;
-    void* m_current;
+    bool Commit(size_t end);
+    void Decommit();
+
+    char* m_base;
     size_t m_size;
     size_t m_used;
+    size_t m_committed;
+    size_t m_commitGranularity;
+    MemoryTag m_tag;
 };
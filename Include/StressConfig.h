@@ -0,0 +1,35 @@
+#pragma once
+
+#include "StandardIncludes.h"
+
+// Speed distribution parsed from "uniform:min:max" or "normal:mean:stddev"
+struct SpeedDistribution {
+    enum class Type { UNIFORM, NORMAL };
+
+    Type Kind;
+    float A;
+    float B;
+
+    SpeedDistribution(Type kind, float a, float b) : Kind(kind), A(a), B(b) {}
+
+    bool Parse(const std::string& spec);
+    float Sample(std::mt19937& gen) const;
+};
+
+// Parameters for StressLevel, read from a key=value file and/or
+// --stress-<key>=<value> command-line overrides
+struct StressConfig {
+    int Warriors;
+    int Rocks;
+    float Density;             // Initial stagger covers 1/Density screens; higher packs tighter
+    SpeedDistribution WarriorSpeed;
+    SpeedDistribution RockSpeed;
+    unsigned int Seed;         // 0 = random
+    float Duration;            // Seconds before quitting; 0 = run until closed
+    bool Collisions;
+
+    StressConfig();
+
+    bool LoadFromFile(const std::string& filepath);
+    bool Set(const std::string& key, const std::string& value);
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Level.h"
+#include "StressConfig.h"
+
+// Load-test level: keeps a configurable population of warriors and rocks
+// on the move, respawning each one as soon as it leaves the screen or dies
+class StressLevel : public Level {
+public:
+    StressLevel(const StressConfig& config);
+    virtual ~StressLevel();
+
+    virtual void Initialize() override;
+    virtual void Update(float deltaTime) override;
+    virtual void Render(FramePacket* packet) override;
+    virtual bool ShouldTransition() const override { return false; }
+    virtual bool ShouldQuit() const override { return m_durationReached; }
+
+    virtual void Serialize(std::ostream& stream) override;
+    virtual void Deserialize(std::istream& stream) override;
+
+private:
+    static const int CELL_SIZE = 128;
+    static const int GRID_COLUMNS = (1920 + CELL_SIZE - 1) / CELL_SIZE;
+    static const int GRID_ROWS = (1080 + CELL_SIZE - 1) / CELL_SIZE;
+
+    Task RunForDuration();
+    void SpawnWarrior(Warrior* warrior);
+    void SpawnRock(Rock* rock);
+    void CheckCollisions(float deltaTime);
+    bool GetCellRange(float x, float y, float w, float h,
+                      int& minCol, int& minRow, int& maxCol, int& maxRow) const;
+
+    StressConfig m_config;
+    std::mt19937 m_gen;
+    bool m_durationReached;   // Set by RunForDuration()
+    std::vector<Rock*> m_rocks;
+
+    // Warrior indices bucketed per grid cell (cell c owns
+    // m_cellWarriors[m_cellStart[c] .. m_cellStart[c + 1]])
+    std::vector<int> m_cellStart;
+    std::vector<int> m_cellWarriors;
+    std::vector<Contact> m_contacts;
+    std::vector<size_t> m_respawns;   // Reused each step
+};
@@ -7,6 +7,12 @@ class TGAReader {
 public:
     static ImageInfo* ReadTGA(const std::string& filepath);
 
+    // Validates the header and reports dimensions without decoding pixels
+    static bool ReadTGAHeader(const std::string& filepath, int& width, int& height, int& bitsPerPixel);
+
+    // Encodes RGBA pixels (top row first) as an uncompressed 32-bit TGA
+    static void EncodeTGA(const unsigned char* rgba, int width, int height, std::vector<unsigned char>& out);
+
 private:
     #pragma pack(push, 1)
     struct TGAHeader {
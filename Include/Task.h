@@ -0,0 +1,123 @@
+#pragma once
+
+#include "EventScheduler.h"
+#include <coroutine>
+#include <functional>
+#include <limits>
+#include <vector>
+
+// A coroutine that runs on an EventScheduler's clock. Inside one,
+// co_await Seconds(s) sleeps for s seconds of scheduler time and
+// co_await Condition(signal, predicate) until the predicate holds. A
+// waiting task is only resumed when its timer fires or its signal is
+// notified, so it costs nothing per frame however long it waits.
+//
+// Tasks start suspended; Start() runs one up to its first wait. Destroying
+// a Task destroys the coroutine and withdraws the wait it's in, so the
+// scheduler and signals it waits on must outlive it.
+class Task {
+public:
+    struct promise_type {
+        EventScheduler* Scheduler = nullptr;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        // Kept until the Task is destroyed, so IsDone() can be asked
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception();
+    };
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    Task() {}
+    Task(Task&& other) noexcept : m_handle(other.m_handle) { other.m_handle = nullptr; }
+    Task& operator=(Task&& other) noexcept;
+    ~Task();
+
+    // Runs the task on scheduler until its first wait
+    void Start(EventScheduler& scheduler);
+
+    bool IsDone() const { return !m_handle || m_handle.done(); }
+
+private:
+    explicit Task(Handle handle) : m_handle(handle) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    Handle m_handle;
+};
+
+// co_await Seconds(s) resumes the task once the scheduler's clock has moved
+// s seconds on. Zero or less still waits for the scheduler's next advance.
+class Seconds {
+public:
+    explicit Seconds(double seconds) : m_seconds(seconds), m_scheduler(nullptr), m_event(0) {}
+    ~Seconds();
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(Task::Handle handle);
+    void await_resume() const noexcept {}
+
+private:
+    Seconds(const Seconds&) = delete;
+    Seconds& operator=(const Seconds&) = delete;
+
+    double m_seconds;
+    EventScheduler* m_scheduler;   // Set while waiting
+    EventScheduler::EventId m_event;
+};
+
+class Condition;
+
+// Something tasks wait on through Condition. Code that changes the state a
+// condition reads calls Notify(), which re-checks the conditions waiting
+// on the signal and resumes the tasks whose predicates now hold. Nothing
+// is re-checked in between.
+class TaskSignal {
+public:
+    TaskSignal() {}
+
+    void Notify();
+
+private:
+    friend class Condition;
+    TaskSignal(const TaskSignal&) = delete;
+    TaskSignal& operator=(const TaskSignal&) = delete;
+
+    std::vector<Condition*> m_waiting;
+};
+
+// co_await Condition(signal, predicate) resumes the task once predicate()
+// holds; it's checked on the spot and then each time signal is notified.
+// With a timeout, it's also checked once more that many seconds later and
+// the task resumes either way. co_await gives the predicate's result, as
+// std::condition_variable::wait_for does.
+class Condition {
+public:
+    typedef std::function<bool()> Predicate;
+
+    Condition(TaskSignal& signal, Predicate predicate,
+              double timeout = std::numeric_limits<double>::infinity());
+    ~Condition();
+
+    bool await_ready() { return m_satisfied = m_predicate(); }
+    void await_suspend(Task::Handle handle);
+    bool await_resume() const noexcept { return m_satisfied; }
+
+private:
+    friend class TaskSignal;
+    Condition(const Condition&) = delete;
+    Condition& operator=(const Condition&) = delete;
+
+    // Stops waiting on the signal and the timer, if it still is
+    void Withdraw();
+    void Resume(bool satisfied);
+
+    TaskSignal& m_signal;
+    Predicate m_predicate;
+    double m_timeout;
+    bool m_satisfied;
+    Task::Handle m_handle;         // Set while waiting
+    EventScheduler* m_scheduler;   // Set while a timeout is pending
+    EventScheduler::EventId m_event;
+};
@@ -4,16 +4,47 @@
 #include "Resource.h"
 #include "Asset.h"
 #include "ObjectPool.h"
+#include "AssetId.h"
 
 class Texture : public Resource {
 public:
     Texture();
     virtual ~Texture();
 
+    // Reads only the header; pixels are decoded on first Acquire(). A
+    // current asset_cook output for filepath is used instead of the TGA.
     bool Load(const std::string& filepath);
     void Unload();
 
+    // Decoded pixels, decoding (or finishing a prefetch) if not resident
+    ImageInfo* Acquire();
+
+    // Drops the decoded pixels but keeps the texture loadable
+    void Evict();
+
+    // Swaps in freshly decoded pixels (takes ownership) and frees the old ones
+    void Reload(ImageInfo* imageInfo);
+
+    // The source changed on disk, so any cooked copy is stale
+    void DiscardCooked() { m_cookedPath.clear(); }
+
+    // Loads pixels from the cooked file if there is one, else decodes the
+    // TGA; safe on any thread
+    static ImageInfo* ReadPixels(const std::string& filepath, const std::string& cookedPath);
+
+    void Touch(Uint64 frame) { m_lastUseFrame = frame; }
+    Uint64 GetLastUseFrame() const { return m_lastUseFrame; }
+    bool IsResident() const { return m_imageInfo != nullptr; }
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    int GetBitsPerPixel() const { return m_bitsPerPixel; }
+    size_t GetByteSize() const { return (size_t)m_width * m_height * (m_bitsPerPixel / 8); }
+
     ImageInfo* GetImageInfo() const { return m_imageInfo; }
+    const std::string& GetFilepath() const { return m_filepath; }
+    const std::string& GetCookedPath() const { return m_cookedPath; }
+    AssetId GetId() const { return m_id; }
     void* GetData() const { return m_imageInfo ? m_imageInfo->Data : nullptr; }
 
     virtual void Serialize(std::ostream& stream) override;
@@ -22,6 +53,15 @@ public:
     static ObjectPool<Texture>* Pool;
 
 private:
+    void SetImageInfo(ImageInfo* imageInfo);
+
     ImageInfo* m_imageInfo;
     std::string m_filepath;
+    std::string m_cookedPath;
+    AssetId m_id;
+    int m_width;
+    int m_height;
+    int m_bitsPerPixel;
+    Uint64 m_lastUseFrame;
+    bool m_registered;
 };
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A uniform scale followed by a translation. Sprites are drawn axis-aligned,
+// so there's no rotation.
+struct Transform {
+    float X;
+    float Y;
+    float Scale;
+
+    // local placed in the space this transform describes
+    Transform Combine(const Transform& local) const {
+        return {X + local.X * Scale, Y + local.Y * Scale, Scale * local.Scale};
+    }
+};
+
+// Parent/child placement for a world's entities and anything attached to
+// them. Each node keeps its local transform and a cached world transform.
+// Changing a node queues it under its depth; Update() then works through
+// the queues shallowest first, so parents are always current before their
+// children, and recomputes only the queued nodes and their descendants.
+// Subtrees that haven't changed cost nothing.
+//
+// Entities are moved by MotionSystem instead, which writes their locals
+// and world transforms in place; see MotionSystem::Update.
+class TransformSystem {
+public:
+    TransformSystem() : m_queued(0) {}
+
+    // Sizes storage for count nodes, so creating them doesn't reallocate
+    void Reserve(size_t count);
+
+    // A root when parent is -1; starts at the identity
+    int CreateNode(int parent = -1);
+
+    // The node's children move up to its parent, keeping their local transforms
+    void ReleaseNode(int node);
+
+    // Keeps the local transform, so the node moves with its new parent
+    void SetParent(int node, int parent);
+    int GetParent(int node) const { return m_parents[node]; }
+    int GetDepth(int node) const { return m_depths[node]; }
+
+    void SetLocal(int node, const Transform& local) {
+        m_localX[node] = local.X;
+        m_localY[node] = local.Y;
+        m_localScale[node] = local.Scale;
+        MarkDirty(node);
+    }
+
+    void SetLocalPosition(int node, float x, float y) {
+        m_localX[node] = x;
+        m_localY[node] = y;
+        MarkDirty(node);
+    }
+
+    void SetLocalScale(int node, float scale) {
+        m_localScale[node] = scale;
+        MarkDirty(node);
+    }
+
+    Transform GetLocal(int node) const { return {m_localX[node], m_localY[node], m_localScale[node]}; }
+
+    // The cached world transform. Only valid once Update() has run since
+    // the last change; reading never updates, so other threads may read
+    // while nothing is being changed.
+    Transform GetWorld(int node) const {
+        assert(m_queued == 0 && "TransformSystem::Update() must run before world transforms are read");
+        return {m_worldX[node], m_worldY[node], m_worldScale[node]};
+    }
+
+    // Recomputes world transforms for changed nodes and their subtrees
+    void Update();
+
+    // Recomputes every node from its roots, changed or not; Update() gives
+    // the same results bit for bit
+    void UpdateReference();
+
+    // Queues node's children, for passes that write a node's world
+    // transform directly
+    void MarkChildrenDirty(int node) {
+        for (int child = m_firstChildren[node]; child >= 0; child = m_nextSiblings[child]) {
+            MarkDirty(child);
+        }
+    }
+
+    // Nodes with at least one child, in no particular order
+    const std::vector<int>& GetParentNodes() const { return m_parentNodes; }
+
+    size_t GetNodeCount() const { return m_parents.size(); }
+
+private:
+    // MotionSystem moves its nodes in place, straight through the packed arrays
+    friend class MotionSystem;
+
+    void MarkDirty(int node) {
+        if (!m_dirty[node]) {
+            m_dirty[node] = 1;
+            QueueAt(node, m_depths[node]);
+        }
+    }
+
+    void QueueAt(int node, int depth);
+    void Attach(int node, int parent);
+    void Detach(int node);
+    void Recompute(int node);
+
+    // Sets the depth of node's subtree and clears its pending changes; the
+    // caller marks node dirty so the whole subtree is recomputed
+    void Reroot(int node, int depth);
+
+    void UpdateSubtree(int node);
+
+    // Packed per-node state, indexed by node handle
+    std::vector<float> m_localX;
+    std::vector<float> m_localY;
+    std::vector<float> m_localScale;
+    std::vector<float> m_worldX;
+    std::vector<float> m_worldY;
+    std::vector<float> m_worldScale;
+    std::vector<int> m_parents;
+    std::vector<int> m_firstChildren;
+    std::vector<int> m_nextSiblings;
+    std::vector<int> m_previousSiblings;
+    std::vector<int> m_depths;       // -1 once released
+    std::vector<int> m_parentSlots;  // Index in m_parentNodes, or -1
+    std::vector<uint8_t> m_dirty;
+    std::vector<int> m_freeNodes;
+    std::vector<int> m_parentNodes;
+
+    // Changed nodes by depth. A node that moves depth while queued leaves
+    // a stale entry behind, skipped because its depth or flag no longer
+    // matches.
+    std::vector<std::vector<int>> m_dirtyByDepth;
+    size_t m_queued;
+};
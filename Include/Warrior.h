@@ -2,50 +2,67 @@
 
 #include "StandardIncludes.h"
 #include "Resource.h"
-#include "Texture.h"
 #include "ObjectPool.h"
+#include "AnimationSystem.h"
+#include "MotionSystem.h"
+#include "TransformSystem.h"
 
-class Renderer;
+class FramePacket;
 
-class Warrior : public Resource {
+class Warrior : public Resource, public AnimationListener {
 public:
     enum class State { RUNNING, DYING, DEAD };
 
+    static constexpr AssetId RUN_CLIP = AssetId("warrior_run");
+    static constexpr AssetId DEATH_CLIP = AssetId("warrior_death");
+
     Warrior();
     virtual ~Warrior();
 
+    // Moves by the world's MotionSystem while running
     void Initialize(float x, float y, float speed, float animSpeed, float scale);
-    void Update(float deltaTime);
-    void Render(Renderer* renderer);
+    void Render(FramePacket* packet);
 
     void StartDeathAnimation();
     bool IsAlive() const { return m_state == State::RUNNING; }
     bool IsDying() const { return m_state == State::DYING; }
     bool IsDead() const { return m_state == State::DEAD; }
-    bool IsOffScreen() const { return m_x > 1920.0f; }
+    bool IsOffScreen() const { return GetX() > 1920.0f; }
 
-    float GetX() const { return m_x; }
-    float GetY() const { return m_y; }
-    float GetWidth() const { return 64.0f * m_scale; }
-    float GetHeight() const { return 64.0f * m_scale; }
+    // World space, from the cached transform of the entity's node
+    float GetX() const { return m_transformSystem->GetWorld(m_transform).X; }
+    float GetY() const { return m_transformSystem->GetWorld(m_transform).Y; }
+    float GetWidth() const { return 64.0f * m_transformSystem->GetWorld(m_transform).Scale; }
+    float GetHeight() const { return 64.0f * m_transformSystem->GetWorld(m_transform).Scale; }
+    float GetVelocityX() const { return IsAlive() ? m_speed * GetParentScale() : 0.0f; }
 
     virtual void Serialize(std::ostream& stream) override;
     virtual void Deserialize(std::istream& stream) override;
 
-    static ObjectPool<Warrior>* Pool;
+    virtual void OnAnimationEnd(int clipId, const std::string& event) override;
 
 private:
-    static const int RUN_FRAMES = 6;
-    static const int DEATH_FRAMES = 8;
+    void BindWorld();
+
+    // Velocities are in the parent's space
+    float GetParentScale() const {
+        int parent = m_transformSystem->GetParent(m_transform);
+        return parent >= 0 ? m_transformSystem->GetWorld(parent).Scale : 1.0f;
+    }
 
-    float m_x, m_y;
     float m_speed;
     float m_scale;
     float m_animSpeed;
-    float m_animTimer;
-    int m_currentFrame;
     State m_state;
 
-    Texture* m_runTexture;
-    Texture* m_deathTexture;
+    // Playback, position and placement belong to the world that first
+    // spawned this warrior; the motion instance drives the node's local position
+    AnimationSystem* m_animationSystem;
+    MotionSystem* m_motionSystem;
+    TransformSystem* m_transformSystem;
+    int m_animation;
+    int m_motion;
+    int m_transform;
+    int m_runClip;
+    int m_deathClip;
 };
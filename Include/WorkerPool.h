@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent worker threads for data-parallel loops. The calling thread
+// joins in, so a pool of N threads runs N + 1 jobs at once.
+class WorkerPool {
+public:
+    // 0 sizes the pool to the hardware, leaving a core for the caller
+    explicit WorkerPool(unsigned int threadCount = 0);
+    ~WorkerPool();
+
+    // Runs job(i) for every i in [0, count) and returns once all are done.
+    // Jobs are claimed dynamically, so uneven jobs balance across threads.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& job);
+
+    unsigned int GetThreadCount() const { return (unsigned int)m_threads.size(); }
+
+private:
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void WorkerLoop();
+    void RunJobs();
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    const std::function<void(size_t)>* m_job;
+    size_t m_count;
+    std::atomic<size_t> m_next;
+    size_t m_active;
+    unsigned long long m_generation;
+    bool m_stopping;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "StandardIncludes.h"
+#include "ObjectPool.h"
+#include "AnimationSystem.h"
+#include "MotionSystem.h"
+#include "TransformSystem.h"
+#include "Warrior.h"
+#include "Rock.h"
+
+// Everything one simulation owns: its entity pools, animation playback,
+// motion and transform state, and spawn seed. The game runs a single
+// world; the simulation farm runs many at once, each bound to the thread
+// that's stepping it. Clip definitions and textures are shared, read-only,
+// by every world.
+class World {
+public:
+    // Without an animation system the world plays its own instances of the
+    // clips already loaded into AnimationSystem::GetInstance()
+    World(size_t warriors, size_t rocks, unsigned int seed, AnimationSystem* animation = nullptr);
+    ~World();
+
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    ObjectPool<Warrior>* GetWarriorPool() { return &m_warriorPool; }
+    ObjectPool<Rock>* GetRockPool() { return &m_rockPool; }
+    AnimationSystem* GetAnimation() { return m_animation; }
+    MotionSystem* GetMotion() { return &m_motion; }
+    TransformSystem* GetTransforms() { return &m_transforms; }
+
+    // The node entities are placed under; moving or scaling it moves the
+    // whole scene, like a camera
+    int GetRoot() const { return m_root; }
+
+    // Levels offset this by their level number; 0 = random
+    unsigned int GetSeed() const { return m_seed; }
+
+    // Levels write and reload Level<N>.bin autosaves; worlds running side
+    // by side would share those files
+    bool IsAutoSaveEnabled() const { return m_autoSave; }
+    void SetAutoSave(bool enabled) { m_autoSave = enabled; }
+
+    // The world new levels and entities on this thread belong to: the one
+    // bound by the innermost Binding, else the default
+    static World* GetCurrent() { return t_current ? t_current : s_default; }
+    static void SetDefault(World* world) { s_default = world; }
+
+    // Binds a world to the current thread for the binding's lifetime
+    class Binding {
+    public:
+        explicit Binding(World* world) : m_previous(t_current) { t_current = world; }
+        ~Binding() { t_current = m_previous; }
+
+        Binding(const Binding&) = delete;
+        Binding& operator=(const Binding&) = delete;
+
+    private:
+        World* m_previous;
+    };
+
+private:
+    std::unique_ptr<AnimationSystem> m_ownedAnimation;
+    AnimationSystem* m_animation;
+    TransformSystem m_transforms;
+    int m_root;
+    MotionSystem m_motion;
+
+    // Declared after the animation, transform and motion systems: pooled
+    // entities release their instances when the pools are destroyed
+    ObjectPool<Warrior> m_warriorPool;
+    ObjectPool<Rock> m_rockPool;
+
+    unsigned int m_seed;
+    bool m_autoSave;
+
+    static World* s_default;
+    static thread_local World* t_current;
+};
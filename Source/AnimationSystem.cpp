@@ -0,0 +1,333 @@
+#include "../Include/AnimationSystem.h"
+#include "../Include/FileController.h"
+#include "../Include/Log.h"
+#include "../Include/CpuFeatures.h"
+#include <sstream>
+
+#ifdef SIMD_DISPATCH
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ANIMATION_SSE2 1
+#endif
+
+namespace {
+    // Adds deltaTime * rate to each playing timer and sets bit i of due for
+    // each instance whose timer reached its frame duration. Stopped lanes
+    // keep their timer through the mask.
+    void AdvanceTimersScalar(float* timers, const float* rates, const float* durations,
+                             const uint32_t* playing, size_t count, float deltaTime, uint32_t& due) {
+        due = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (playing[i]) {
+                timers[i] += deltaTime * rates[i];
+                if (timers[i] >= durations[i]) {
+                    due |= 1u << i;
+                }
+            }
+        }
+    }
+
+#ifdef ANIMATION_SSE2
+    const size_t SSE2_LANES = 4;
+
+    void AdvanceTimersSSE2(float* timers, const float* rates, const float* durations,
+                           const uint32_t* playing, float deltaTime, uint32_t& due) {
+        __m128 mask = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(playing)));
+        __m128 oldTimer = _mm_loadu_ps(timers);
+        __m128 timer = _mm_add_ps(oldTimer, _mm_mul_ps(_mm_set1_ps(deltaTime), _mm_loadu_ps(rates)));
+        timer = _mm_or_ps(_mm_and_ps(mask, timer), _mm_andnot_ps(mask, oldTimer));
+        _mm_storeu_ps(timers, timer);
+        due = (uint32_t)_mm_movemask_ps(_mm_and_ps(mask, _mm_cmpge_ps(timer, _mm_loadu_ps(durations))));
+    }
+#endif
+
+    inline int LowestBit(uint32_t mask) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (int)index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+#ifdef SIMD_DISPATCH
+    const size_t AVX_LANES = 8;
+
+    // The whole loop carries the AVX target, so the kernel inlines into it;
+    // calls advance(i) for each instance due a frame and returns the first
+    // instance left over
+    template<typename Advance>
+    SIMD_TARGET("avx") size_t AdvanceTimersAVX(float* timers, const float* rates, const float* durations,
+                                               const uint32_t* playing, size_t count, float deltaTime,
+                                               Advance advance) {
+        size_t i = 0;
+        for (; i + AVX_LANES <= count; i += AVX_LANES) {
+            __m256 mask = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(playing + i)));
+            __m256 oldTimer = _mm256_loadu_ps(timers + i);
+            __m256 timer = _mm256_add_ps(oldTimer, _mm256_mul_ps(_mm256_set1_ps(deltaTime), _mm256_loadu_ps(rates + i)));
+            // Bitwise rather than blendv, which GCC turns into per-lane
+            // branches for a loaded integer mask when AVX2 is off
+            timer = _mm256_or_ps(_mm256_and_ps(mask, timer), _mm256_andnot_ps(mask, oldTimer));
+            _mm256_storeu_ps(timers + i, timer);
+            uint32_t due = (uint32_t)_mm256_movemask_ps(
+                _mm256_and_ps(mask, _mm256_cmp_ps(timer, _mm256_loadu_ps(durations + i), _CMP_GE_OQ)));
+            for (; due; due &= due - 1) {
+                advance(i + LowestBit(due));
+            }
+        }
+        return i;
+    }
+#endif
+}
+
+AnimationSystem::AnimationSystem() : m_sharedClips(false) {
+}
+
+AnimationSystem::~AnimationSystem() {
+    Shutdown();
+}
+
+bool AnimationSystem::LoadClips(const std::string& filepath) {
+    FileView data;
+    if (!FileController::GetInstance()->OpenFile(filepath, data)) {
+        return false;
+    }
+
+    std::istringstream file(std::string(data.Data, data.Data + data.Size));
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream tokens(line);
+        std::string name;
+        if (!(tokens >> name) || name[0] == '#') {
+            continue;
+        }
+
+        // name texture frames loop|once end-event [duration per frame...]
+        std::string texturePath, mode, endEvent;
+        int frameCount = 0;
+        if (!(tokens >> texturePath >> frameCount >> mode >> endEvent) || frameCount <= 0) {
+            LOG_ERROR("Invalid animation clip: %s", line.c_str());
+            continue;
+        }
+
+        AnimationClip clip;
+        clip.Name = name;
+        clip.Id = AssetId::Register(name);
+        clip.Loop = (mode == "loop");
+        clip.EndEvent = (endEvent == "none") ? "" : endEvent;
+
+        float duration;
+        while (tokens >> duration) {
+            clip.FrameDurations.push_back(std::max(duration, 0.001f));
+        }
+        clip.FrameDurations.resize(frameCount, clip.FrameDurations.empty() ? 1.0f : clip.FrameDurations.back());
+
+        clip.SheetTexture = Texture::Pool->GetResource();
+        clip.SheetTexture->Load(texturePath);
+        BuildFrameRects(clip, frameCount);
+
+        m_clipIndex.Insert(clip.Id, (int)m_clips.size());
+        m_clips.push_back(clip);
+    }
+
+    return !m_clips.empty();
+}
+
+void AnimationSystem::ShareClips(const AnimationSystem& library) {
+    Shutdown();
+    m_clips = library.m_clips;
+    m_clipIndex = library.m_clipIndex;
+    m_sharedClips = true;
+}
+
+void AnimationSystem::Shutdown() {
+    for (AnimationClip& clip : m_clips) {
+        if (clip.SheetTexture && Texture::Pool && !m_sharedClips) {
+            clip.SheetTexture->Unload();
+            Texture::Pool->ReturnResource(clip.SheetTexture);
+        }
+    }
+    m_clips.clear();
+    m_clipIndex.Clear();
+    m_sharedClips = false;
+}
+
+void AnimationSystem::BuildFrameRects(AnimationClip& clip, int frameCount) {
+    // Dimensions come from the header, so this doesn't force a decode
+    float frameWidth = (float)(clip.SheetTexture->GetWidth() / frameCount);
+    float frameHeight = (float)clip.SheetTexture->GetHeight();
+
+    clip.Frames.resize(frameCount);
+    for (int i = 0; i < frameCount; ++i) {
+        clip.Frames[i] = {i * frameWidth, 0.0f, frameWidth, frameHeight};
+    }
+}
+
+void AnimationSystem::RefreshClips(Texture* texture) {
+    for (AnimationClip& clip : m_clips) {
+        if (clip.SheetTexture == texture) {
+            BuildFrameRects(clip, (int)clip.Frames.size());
+        }
+    }
+
+    // Instances only copy a frame's rect when they move to it
+    for (size_t i = 0; i < m_clipIds.size(); ++i) {
+        int clipId = m_clipIds[i];
+        if (clipId >= 0 && m_clips[clipId].SheetTexture == texture) {
+            m_srcRects[i] = m_clips[clipId].Frames[m_frames[i]];
+        }
+    }
+}
+
+int AnimationSystem::FindClip(AssetId id) const {
+    const int* clipId = m_clipIndex.Find(id);
+    if (clipId) {
+        return *clipId;
+    }
+
+    LOG_ERROR("Unknown animation clip: %s", id.GetName().c_str());
+    return -1;
+}
+
+int AnimationSystem::CreateInstance(AnimationListener* listener) {
+    int instance;
+    if (!m_freeInstances.empty()) {
+        instance = m_freeInstances.back();
+        m_freeInstances.pop_back();
+    } else {
+        instance = (int)m_timers.size();
+        m_timers.push_back(0.0f);
+        m_rates.push_back(0.0f);
+        m_frameDurations.push_back(0.0f);
+        m_frames.push_back(0);
+        m_clipIds.push_back(-1);
+        m_playing.push_back(0);
+        m_srcRects.push_back({0.0f, 0.0f, 0.0f, 0.0f});
+        m_listeners.push_back(nullptr);
+    }
+
+    m_listeners[instance] = listener;
+    return instance;
+}
+
+void AnimationSystem::ReleaseInstance(int instance) {
+    m_playing[instance] = 0;
+    m_clipIds[instance] = -1;
+    m_listeners[instance] = nullptr;
+    m_freeInstances.push_back(instance);
+}
+
+void AnimationSystem::Play(int instance, int clipId, float rate) {
+    m_clipIds[instance] = clipId;
+    m_rates[instance] = rate;
+    m_playing[instance] = (clipId >= 0) ? ~0u : 0u;
+    SetState(instance, 0, 0.0f);
+}
+
+void AnimationSystem::SetState(int instance, int frame, float timer) {
+    int clipId = m_clipIds[instance];
+    if (clipId < 0) {
+        return;
+    }
+
+    const AnimationClip& clip = m_clips[clipId];
+    frame = std::min(std::max(frame, 0), (int)clip.Frames.size() - 1);
+
+    m_frames[instance] = frame;
+    m_timers[instance] = timer;
+    m_frameDurations[instance] = clip.FrameDurations[frame];
+    m_srcRects[instance] = clip.Frames[frame];
+}
+
+void AnimationSystem::Update(float deltaTime) {
+    const size_t count = m_timers.size();
+    float* timers = m_timers.data();
+    const float* rates = m_rates.data();
+    const float* durations = m_frameDurations.data();
+    const uint32_t* playing = m_playing.data();
+
+    // Most steps cross no frame boundary, so due is usually zero
+    size_t i = 0;
+    uint32_t due;
+    SimdLevel level = CpuFeatures::GetSimdLevel();
+#ifdef SIMD_DISPATCH
+    if (level >= SimdLevel::AVX) {
+        i = AdvanceTimersAVX(timers, rates, durations, playing, count, deltaTime,
+                             [this](size_t instance) { AdvanceFrames((int)instance); });
+    }
+#endif
+#ifdef ANIMATION_SSE2
+    for (; level >= SimdLevel::SSE2 && i + SSE2_LANES <= count; i += SSE2_LANES) {
+        AdvanceTimersSSE2(timers + i, rates + i, durations + i, playing + i, deltaTime, due);
+        for (; due; due &= due - 1) {
+            AdvanceFrames((int)(i + LowestBit(due)));
+        }
+    }
+#endif
+    for (; i < count; i += 32) {
+        size_t lanes = std::min<size_t>(count - i, 32);
+        AdvanceTimersScalar(timers + i, rates + i, durations + i, playing + i, lanes, deltaTime, due);
+        for (; due; due &= due - 1) {
+            AdvanceFrames((int)(i + LowestBit(due)));
+        }
+    }
+
+    DispatchFinished();
+}
+
+void AnimationSystem::UpdateReference(float deltaTime) {
+    const size_t count = m_timers.size();
+    for (size_t i = 0; i < count; ++i) {
+        if (!m_playing[i]) continue;
+
+        m_timers[i] += deltaTime * m_rates[i];
+        if (m_timers[i] >= m_frameDurations[i]) {
+            AdvanceFrames((int)i);
+        }
+    }
+
+    DispatchFinished();
+}
+
+void AnimationSystem::AdvanceFrames(int instance) {
+    const AnimationClip& clip = m_clips[m_clipIds[instance]];
+    const int frameCount = (int)clip.Frames.size();
+    float timer = m_timers[instance];
+    int frame = m_frames[instance];
+
+    while (timer >= clip.FrameDurations[frame]) {
+        timer -= clip.FrameDurations[frame];
+        if (++frame < frameCount) continue;
+
+        if (clip.Loop) {
+            frame = 0;
+        } else {
+            // One-shot clips hold their last frame
+            frame = frameCount - 1;
+            timer = 0.0f;
+            m_playing[instance] = 0;
+            m_finished.push_back(instance);
+            break;
+        }
+    }
+
+    m_timers[instance] = timer;
+    m_frames[instance] = frame;
+    m_frameDurations[instance] = clip.FrameDurations[frame];
+    m_srcRects[instance] = clip.Frames[frame];
+}
+
+void AnimationSystem::DispatchFinished() {
+    // Listeners may start new clips, so dispatch outside the update loop
+    for (int instance : m_finished) {
+        AnimationListener* listener = m_listeners[instance];
+        int clipId = m_clipIds[instance];
+        if (listener) {
+            listener->OnAnimationEnd(clipId, m_clips[clipId].EndEvent);
+        }
+    }
+    m_finished.clear();
+}
@@ -0,0 +1,249 @@
+#include "../Include/AssetArchive.h"
+#include "../Include/Log.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+AssetArchive::AssetArchive()
+    : m_base(nullptr), m_size(0), m_header(nullptr), m_entries(nullptr), m_names(nullptr)
+#ifdef _WIN32
+    , m_file(nullptr), m_mapping(nullptr)
+#endif
+{
+}
+
+AssetArchive::~AssetArchive() {
+    Close();
+}
+
+bool AssetArchive::Open(const std::string& filepath) {
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* base = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!base) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_mapping = mapping;
+    m_size = (size_t)fileSize.QuadPart;
+#else
+    int fd = open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    void* base = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+
+    m_size = (size_t)info.st_size;
+#endif
+
+    m_base = static_cast<const unsigned char*>(base);
+    m_header = reinterpret_cast<const PakHeader*>(m_base);
+
+    if (m_size < sizeof(PakHeader) || memcmp(m_header->Magic, "PAK1", 4) != 0 ||
+        m_header->Version != VERSION ||
+        m_header->IndexOffset + (uint64_t)m_header->EntryCount * sizeof(PakEntry) > m_size ||
+        m_header->NamesOffset + m_header->NamesSize > m_size) {
+        LOG_ERROR("Invalid asset archive: %s", filepath.c_str());
+        Close();
+        return false;
+    }
+
+    m_entries = reinterpret_cast<const PakEntry*>(m_base + m_header->IndexOffset);
+    m_names = reinterpret_cast<const char*>(m_base + m_header->NamesOffset);
+    return true;
+}
+
+void AssetArchive::Close() {
+    if (m_base) {
+#ifdef _WIN32
+        UnmapViewOfFile(m_base);
+        CloseHandle((HANDLE)m_mapping);
+        CloseHandle((HANDLE)m_file);
+        m_mapping = nullptr;
+        m_file = nullptr;
+#else
+        munmap(const_cast<unsigned char*>(m_base), m_size);
+#endif
+    }
+
+    m_base = nullptr;
+    m_size = 0;
+    m_header = nullptr;
+    m_entries = nullptr;
+    m_names = nullptr;
+}
+
+const AssetArchive::PakEntry* AssetArchive::FindEntry(uint64_t hash) const {
+    if (!m_base) {
+        return nullptr;
+    }
+
+    const PakEntry* end = m_entries + m_header->EntryCount;
+    const PakEntry* entry = std::lower_bound(m_entries, end, hash,
+        [](const PakEntry& e, uint64_t h) { return e.PathHash < h; });
+
+    if (entry == end || entry->PathHash != hash || entry->Offset + entry->Size > m_size) {
+        return nullptr;
+    }
+    return entry;
+}
+
+bool AssetArchive::Find(const std::string& path, const unsigned char*& data, size_t& size) const {
+    // Confirm the name so a path outside the archive can't alias an entry
+    const PakEntry* entry = FindEntry(AssetId(path).Value);
+    if (!entry || entry->NameLength != path.size() ||
+        memcmp(m_names + entry->NameOffset, path.data(), path.size()) != 0) {
+        return false;
+    }
+
+    data = m_base + entry->Offset;
+    size = (size_t)entry->Size;
+    return true;
+}
+
+bool AssetArchive::Find(AssetId id, const unsigned char*& data, size_t& size) const {
+    const PakEntry* entry = FindEntry(id.Value);
+    if (!entry) {
+        return false;
+    }
+
+    data = m_base + entry->Offset;
+    size = (size_t)entry->Size;
+    return true;
+}
+
+bool AssetArchive::FindPath(AssetId id, std::string& path) const {
+    const PakEntry* entry = FindEntry(id.Value);
+    if (!entry || entry->NameOffset + entry->NameLength > m_header->NamesSize) {
+        return false;
+    }
+
+    path.assign(m_names + entry->NameOffset, entry->NameLength);
+    return true;
+}
+
+bool AssetArchive::Pack(const std::string& directory, const std::string& outputPath) {
+    namespace fs = std::filesystem;
+
+    std::error_code error;
+    fs::path root = fs::path(directory).lexically_normal();
+    fs::path parent = root.parent_path();
+
+    std::vector<std::string> paths;
+    for (auto& item : fs::recursive_directory_iterator(root, error)) {
+        if (item.is_regular_file()) {
+            paths.push_back(item.path().lexically_relative(parent).generic_string());
+        }
+    }
+    if (error) {
+        LOG_ERROR("Failed to scan %s: %s", directory.c_str(), error.message().c_str());
+        return false;
+    }
+
+    std::vector<PakEntry> entries(paths.size());
+    std::string names;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        entries[i].PathHash = AssetId(paths[i]).Value;
+        entries[i].NameOffset = (uint32_t)names.size();
+        entries[i].NameLength = (uint32_t)paths[i].size();
+        names += paths[i];
+    }
+
+    // Sort the index by hash, keeping each entry's name alongside
+    std::vector<size_t> order(paths.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(),
+        [&](size_t a, size_t b) { return entries[a].PathHash < entries[b].PathHash; });
+
+    // Ids are looked up without their names, so they must be unique
+    for (size_t i = 1; i < order.size(); ++i) {
+        if (entries[order[i]].PathHash == entries[order[i - 1]].PathHash) {
+            LOG_ERROR("Asset id collision: %s and %s", paths[order[i - 1]].c_str(), paths[order[i]].c_str());
+            return false;
+        }
+    }
+
+    PakHeader header;
+    memcpy(header.Magic, "PAK1", 4);
+    header.Version = VERSION;
+    header.EntryCount = (uint32_t)paths.size();
+    header.NamesSize = (uint32_t)names.size();
+    header.IndexOffset = sizeof(PakHeader);
+    header.NamesOffset = header.IndexOffset + entries.size() * sizeof(PakEntry);
+
+    std::ofstream out(outputPath, std::ios::binary);
+    if (!out.is_open()) {
+        LOG_ERROR("Failed to create archive: %s", outputPath.c_str());
+        return false;
+    }
+
+    // Data goes first so entry offsets are known before the index is written
+    uint64_t offset = header.NamesOffset + names.size();
+    std::vector<PakEntry> sorted;
+    std::vector<char> padding;
+    out.seekp((std::streamoff)offset);
+    for (size_t i : order) {
+        uint64_t aligned = (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        padding.assign((size_t)(aligned - offset), 0);
+        out.write(padding.data(), padding.size());
+
+        std::ifstream file(fs::path(parent) / paths[i], std::ios::binary);
+        std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        out.write(data.data(), data.size());
+
+        entries[i].Offset = aligned;
+        entries[i].Size = data.size();
+        sorted.push_back(entries[i]);
+        offset = aligned + data.size();
+    }
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(sorted.data()), sorted.size() * sizeof(PakEntry));
+    out.write(names.data(), names.size());
+
+    if (!out.good()) {
+        LOG_ERROR("Failed to write archive: %s", outputPath.c_str());
+        return false;
+    }
+
+    LOG_INFO("Packed %zu files into %s", paths.size(), outputPath.c_str());
+    return true;
+}
@@ -1,22 +1,42 @@
 #include "../Include/AssetController.h"
 #include "../Include/FileController.h"
+#include "../Include/TGAReader.h"
+#include "../Include/Texture.h"
+#include "../Include/ResidencyManager.h"
+#include "../Include/MemoryTracker.h"
+#include "../Include/Log.h"
+#include <filesystem>
 
-AssetController::AssetController() : m_allocator(nullptr) {
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+AssetController::AssetController()
+    : m_allocator(nullptr), m_reloadsPending(false), m_inotifyFd(-1), m_wakeFds{-1, -1} {
 }
 
 AssetController::~AssetController() {
     Shutdown();
 }
 
-void AssetController::Initialize(size_t stackSize) {
-    m_allocator = new StackAllocator(stackSize);
+void AssetController::Initialize(size_t reserveSize) {
+    m_allocator = new StackAllocator(reserveSize, MemoryTag::ASSETS, true);
 }
 
 void AssetController::Shutdown() {
-    for (auto& pair : m_assets) {
+    StopWatching();
+
+    for (auto& pair : m_pendingReloads) {
+        delete[] pair.second->Data;
         delete pair.second;
     }
-    m_assets.clear();
+    m_pendingReloads.clear();
+
+    m_assets.ForEach([](AssetId, Asset* asset) { delete asset; });
+    m_assets.Clear();
+    m_paths.Clear();
 
     if (m_allocator) {
         delete m_allocator;
@@ -26,37 +46,239 @@ void AssetController::Shutdown() {
 
 Asset* AssetController::LoadAsset(const std::string& filepath) {
     // Check if already loaded
-    auto it = m_assets.find(filepath);
-    if (it != m_assets.end()) {
-        return it->second;
+    AssetId id = AssetId::Register(filepath);
+    Asset* loaded = FindAsset(id);
+    if (loaded) {
+        return loaded;
     }
 
     // Load new asset
-    std::vector<unsigned char> data;
-    if (!FileController::GetInstance()->ReadFile(filepath, data)) {
+    FileView data;
+    if (!FileController::GetInstance()->OpenFile(filepath, data)) {
         return nullptr;
     }
 
     // Allocate from stack
-    void* memory = m_allocator->Allocate(data.size());
+    void* memory = m_allocator->Allocate(data.Size);
     if (!memory) {
-        std::cerr << "Stack allocator out of memory!" << std::endl;
+        LOG_ERROR("Stack allocator out of memory!");
         return nullptr;
     }
 
-    memcpy(memory, data.data(), data.size());
+    memcpy(memory, data.Data, data.Size);
 
+    MemoryScope scope(MemoryTag::ASSETS);
     Asset* asset = new Asset();
-    asset->SetData(memory, data.size());
-    m_assets[filepath] = asset;
+    asset->SetData(memory, data.Size);
+    m_assets.Insert(id, asset);
 
     return asset;
 }
 
-void AssetController::UnloadAsset(const std::string& filepath) {
-    auto it = m_assets.find(filepath);
-    if (it != m_assets.end()) {
-        delete it->second;
-        m_assets.erase(it);
+Asset* AssetController::FindAsset(AssetId id) {
+    Asset** asset = m_assets.Find(id);
+    return asset ? *asset : nullptr;
+}
+
+void AssetController::UnloadAsset(AssetId id) {
+    Asset* asset = FindAsset(id);
+    if (asset) {
+        delete asset;
+        m_assets.Remove(id);
+    }
+}
+
+bool AssetController::RegisterPaths(const std::string& directory) {
+    namespace fs = std::filesystem;
+
+    // Same keys as AssetArchive::Pack: relative to the directory's parent
+    std::error_code error;
+    fs::path root = fs::path(directory).lexically_normal();
+    fs::path parent = root.parent_path();
+    for (auto& item : fs::recursive_directory_iterator(root, error)) {
+        if (item.is_regular_file()) {
+            std::string path = item.path().lexically_relative(parent).generic_string();
+            m_paths.Insert(AssetId(path), path);
+        }
+    }
+    if (error) {
+        LOG_ERROR("Failed to scan %s: %s", directory.c_str(), error.message().c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool AssetController::ResolvePath(AssetId id, std::string& path) const {
+    if (FileController::GetInstance()->FindArchivePath(id, path)) {
+        return true;
+    }
+
+    const std::string* registered = m_paths.Find(id);
+    if (registered) {
+        path = *registered;
+        return true;
+    }
+
+    if (id.FindName(path)) {
+        return true;
+    }
+
+    LOG_ERROR("Unknown asset id: %s", id.GetName().c_str());
+    return false;
+}
+
+#ifdef __linux__
+
+bool AssetController::StartWatching(const std::string& directory) {
+    if (m_watchThread.joinable()) {
+        return true;
+    }
+
+    m_inotifyFd = inotify_init1(IN_CLOEXEC);
+    if (m_inotifyFd < 0 || pipe(m_wakeFds) != 0) {
+        LOG_ERROR("Failed to start asset watcher");
+        StopWatching();
+        return false;
+    }
+
+    // inotify watches aren't recursive, so add every directory
+    std::error_code error;
+    std::vector<std::string> directories = {directory};
+    for (auto& entry : std::filesystem::recursive_directory_iterator(directory, error)) {
+        if (entry.is_directory()) {
+            directories.push_back(entry.path().generic_string());
+        }
+    }
+
+    // Editors often save to a temp file and rename it over the original
+    for (const std::string& dir : directories) {
+        int wd = inotify_add_watch(m_inotifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd >= 0) {
+            m_watchDirs[wd] = dir;
+        }
+    }
+
+    m_watchThread = std::thread(&AssetController::WatchThread, this);
+    return true;
+}
+
+void AssetController::StopWatching() {
+    if (m_watchThread.joinable()) {
+        char wake = 1;
+        if (write(m_wakeFds[1], &wake, 1) < 0) {
+            LOG_ERROR("Failed to wake asset watcher");
+        }
+        m_watchThread.join();
+    }
+
+    if (m_inotifyFd >= 0) {
+        close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+    for (int& fd : m_wakeFds) {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    m_watchDirs.clear();
+}
+
+void AssetController::WatchThread() {
+    alignas(inotify_event) char buffer[4096];
+    pollfd fds[2] = {{m_inotifyFd, POLLIN, 0}, {m_wakeFds[0], POLLIN, 0}};
+
+    // Blocks until a file changes or StopWatching() writes to the wake pipe
+    while (poll(fds, 2, -1) >= 0 && !(fds[1].revents & POLLIN)) {
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        ssize_t length = read(m_inotifyFd, buffer, sizeof(buffer));
+        for (ssize_t offset = 0; offset < length; ) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->len == 0) continue;
+            std::string name = event->name;
+            if (name.size() < 4 || name.compare(name.size() - 4, 4, ".tga") != 0) continue;
+
+            auto dir = m_watchDirs.find(event->wd);
+            if (dir != m_watchDirs.end()) {
+                QueueReload(dir->second + "/" + name);
+            }
+        }
+    }
+}
+
+#else
+
+bool AssetController::StartWatching(const std::string& directory) {
+    LOG_WARN("Asset hot reload is only supported on Linux");
+    return false;
+}
+
+void AssetController::StopWatching() {
+}
+
+void AssetController::WatchThread() {
+}
+
+#endif
+
+void AssetController::QueueReload(const std::string& filepath) {
+    // Decode here on the watcher thread; the main thread only swaps pointers
+    ImageInfo* info = TGAReader::ReadTGA(filepath);
+    if (!info) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_reloadMutex);
+    ImageInfo*& pending = m_pendingReloads[filepath];
+    if (pending) {
+        delete[] pending->Data;
+        delete pending;
+    }
+    pending = info;
+    m_reloadsPending.store(true, std::memory_order_release);
+}
+
+void AssetController::ApplyPendingReloads(std::vector<Texture*>& reloaded) {
+    if (!m_reloadsPending.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    std::map<std::string, ImageInfo*> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_reloadMutex);
+        pending.swap(m_pendingReloads);
+        m_reloadsPending.store(false, std::memory_order_relaxed);
+    }
+
+    for (auto& pair : pending) {
+        ImageInfo* info = pair.second;
+        AssetId id(pair.first);
+        for (Texture* texture : ResidencyManager::GetInstance()->GetTextures()) {
+            if (texture->GetId() != id) continue;
+
+            // Each texture owns its pixels; the first takes the decode, others copy it
+            if (!info) {
+                MemoryScope scope(MemoryTag::TEXTURES);
+                info = new ImageInfo(*pair.second);
+                size_t size = (size_t)info->Width * info->Height * (info->BitsPerPixel / 8);
+                info->Data = new unsigned char[size];
+                memcpy(info->Data, pair.second->Data, size);
+            }
+            texture->DiscardCooked();
+            texture->Reload(info);
+            info = nullptr;
+            reloaded.push_back(texture);
+        }
+
+        if (info) {
+            delete[] info->Data;
+            delete info;
+        }
+
+        LOG_INFO("Reloaded asset: %s", pair.first.c_str());
     }
 }
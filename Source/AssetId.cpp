@@ -0,0 +1,50 @@
+#include "../Include/AssetId.h"
+#include "../Include/AssetTable.h"
+#include "../Include/MemoryTracker.h"
+#include <mutex>
+#include <sstream>
+
+#ifndef NDEBUG
+namespace {
+    std::mutex s_namesMutex;
+
+    AssetTable<std::string>& Names() {
+        static AssetTable<std::string> names;
+        return names;
+    }
+}
+#endif
+
+AssetId AssetId::Register(const std::string& path) {
+    AssetId id(path);
+#ifndef NDEBUG
+    std::lock_guard<std::mutex> lock(s_namesMutex);
+    // Names live for the whole process; don't charge them to the caller
+    MemoryScope scope(MemoryTag::UNTAGGED);
+    Names().Insert(id, path);
+#endif
+    return id;
+}
+
+bool AssetId::FindName(std::string& name) const {
+#ifndef NDEBUG
+    std::lock_guard<std::mutex> lock(s_namesMutex);
+    const std::string* registered = Names().Find(*this);
+    if (registered) {
+        name = *registered;
+        return true;
+    }
+#endif
+    return false;
+}
+
+std::string AssetId::GetName() const {
+    std::string name;
+    if (FindName(name)) {
+        return name;
+    }
+
+    std::ostringstream hex;
+    hex << "0x" << std::hex << Value;
+    return hex.str();
+}
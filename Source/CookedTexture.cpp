@@ -0,0 +1,158 @@
+#include "../Include/CookedTexture.h"
+#include "../Include/FileController.h"
+#include "../Include/MemoryTracker.h"
+#include "../Include/SoftwareRasterizer.h"
+#include "../Include/Log.h"
+#include <cstring>
+#include <filesystem>
+
+std::string CookedTexture::GetCookedPath(const std::string& sourcePath) {
+    size_t dot = sourcePath.find_last_of('.');
+    size_t slash = sourcePath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return sourcePath + ".ctex";
+    }
+    return sourcePath.substr(0, dot) + ".ctex";
+}
+
+bool CookedTexture::FindCooked(const std::string& sourcePath, std::string& cookedPath) {
+    cookedPath = GetCookedPath(sourcePath);
+
+    // Packed together, so an archived cook always matches its source
+    const unsigned char* data;
+    size_t size;
+    if (FileController::GetInstance()->FindInArchive(cookedPath, data, size)) {
+        return true;
+    }
+
+    namespace fs = std::filesystem;
+    std::error_code error;
+    auto cookedTime = fs::last_write_time(cookedPath, error);
+    if (error) {
+        return false;
+    }
+    auto sourceTime = fs::last_write_time(sourcePath, error);
+    return error || cookedTime >= sourceTime;
+}
+
+bool CookedTexture::Cook(const ImageInfo& image, std::vector<unsigned char>& out) {
+    if (image.Width <= 0 || image.Height <= 0 || (image.BitsPerPixel != 24 && image.BitsPerPixel != 32)) {
+        return false;
+    }
+
+    // The rasterizer's conversion is the one every draw path must match
+    RasterImage pixels;
+    pixels.Convert(&image);
+
+    Header header = {};
+    memcpy(header.Magic, "CTEX", 4);
+    header.Version = VERSION;
+    header.Width = (uint32_t)image.Width;
+    header.Height = (uint32_t)image.Height;
+    header.Format = SDL_PIXELFORMAT_RGBA32;
+    header.Flags = FLAG_PREMULTIPLIED;
+    header.Pitch = header.Width * 4;
+    header.DataOffset = (sizeof(Header) + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+    header.DataSize = (uint64_t)header.Pitch * header.Height;
+
+    out.assign(header.DataOffset + header.DataSize, 0);
+    memcpy(out.data(), &header, sizeof(Header));
+    memcpy(out.data() + header.DataOffset, pixels.Pixels.data(), (size_t)header.DataSize);
+    return true;
+}
+
+bool CookedTexture::Validate(const Header& header, const std::string& filepath) {
+    if (memcmp(header.Magic, "CTEX", 4) != 0 || header.Version != VERSION) {
+        LOG_ERROR("Not a cooked texture (or cooked by another version): %s", filepath.c_str());
+        return false;
+    }
+
+    if (header.Format != SDL_PIXELFORMAT_RGBA32 || header.Width == 0 || header.Height == 0 ||
+        header.Pitch != header.Width * 4 || header.DataSize != (uint64_t)header.Pitch * header.Height ||
+        header.DataOffset < sizeof(Header) || header.DataOffset % DATA_ALIGNMENT != 0) {
+        LOG_ERROR("Invalid cooked texture: %s", filepath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool CookedTexture::ValidateSize(const Header& header, size_t fileSize, const std::string& filepath) {
+    if (header.DataOffset + header.DataSize > fileSize) {
+        LOG_ERROR("Truncated cooked texture: %s", filepath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool CookedTexture::ReadHeader(const std::string& filepath, int& width, int& height, int& bitsPerPixel) {
+    Header header;
+    if (!FileController::GetInstance()->ReadFileHeader(filepath, &header, sizeof(Header))) {
+        return false;
+    }
+
+    // The file size is checked when the pixels are read
+    if (!Validate(header, filepath)) {
+        return false;
+    }
+
+    width = (int)header.Width;
+    height = (int)header.Height;
+    bitsPerPixel = 32;
+    return true;
+}
+
+ImageInfo* CookedTexture::Read(const std::string& filepath) {
+    // Runs on loader threads too, so tag here rather than at the callers
+    MemoryScope scope(MemoryTag::TEXTURES);
+
+    Header header;
+    unsigned char* pixels = nullptr;
+    bool mapped = false;
+
+    const unsigned char* data;
+    size_t size;
+    if (FileController::GetInstance()->FindInArchive(filepath, data, size)) {
+        if (size < sizeof(Header)) {
+            LOG_ERROR("Invalid cooked texture: %s", filepath.c_str());
+            return nullptr;
+        }
+        memcpy(&header, data, sizeof(Header));
+        if (!Validate(header, filepath) || !ValidateSize(header, size, filepath)) {
+            return nullptr;
+        }
+
+        // Archive entries start on 4 KB boundaries, so the pixels stay aligned
+        pixels = const_cast<unsigned char*>(data + header.DataOffset);
+        mapped = true;
+    } else {
+        std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            LOG_ERROR("Failed to open file: %s", filepath.c_str());
+            return nullptr;
+        }
+
+        size_t fileSize = (size_t)file.tellg();
+        file.seekg(0, std::ios::beg);
+        if (fileSize < sizeof(Header) || !file.read(reinterpret_cast<char*>(&header), sizeof(Header)) ||
+            !Validate(header, filepath) || !ValidateSize(header, fileSize, filepath)) {
+            return nullptr;
+        }
+
+        pixels = new unsigned char[(size_t)header.DataSize];
+        file.seekg(header.DataOffset, std::ios::beg);
+        if (!file.read(reinterpret_cast<char*>(pixels), (std::streamsize)header.DataSize)) {
+            LOG_ERROR("Failed to read file: %s", filepath.c_str());
+            delete[] pixels;
+            return nullptr;
+        }
+    }
+
+    ImageInfo* info = new ImageInfo();
+    info->Width = (int)header.Width;
+    info->Height = (int)header.Height;
+    info->BitsPerPixel = 32;
+    info->Data = pixels;
+    info->Premultiplied = (header.Flags & FLAG_PREMULTIPLIED) != 0;
+    info->Mapped = mapped;
+    return info;
+}
@@ -0,0 +1,72 @@
+#include "../Include/CpuFeatures.h"
+#include <algorithm>
+#include <atomic>
+
+#if defined(_MSC_VER) && defined(SIMD_DISPATCH)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+    std::atomic<int> s_limit((int)SimdLevel::AVX2);
+
+    SimdLevel Detect() {
+#if !defined(SIMD_DISPATCH)
+#if defined(__SSE2__)
+        return SimdLevel::SSE2;
+#else
+        return SimdLevel::SCALAR;
+#endif
+#elif defined(_MSC_VER)
+        // AVX needs the OS to save the YMM registers too (OSXSAVE, XCR0 bits 1-2)
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+        __cpuid(info, 1);
+        bool avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+        if (!avx) {
+            return SimdLevel::SSE2;
+        }
+        if (maxLeaf >= 7) {
+            __cpuidex(info, 7, 0);
+            if (info[1] & (1 << 5)) {
+                return SimdLevel::AVX2;
+            }
+        }
+        return SimdLevel::AVX;
+#else
+        // Checks OS support for the YMM state as well
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+        if (__builtin_cpu_supports("avx")) {
+            return SimdLevel::AVX;
+        }
+        return SimdLevel::SSE2;
+#endif
+    }
+}
+
+SimdLevel CpuFeatures::GetSupportedSimdLevel() {
+    static const SimdLevel supported = Detect();
+    return supported;
+}
+
+SimdLevel CpuFeatures::GetSimdLevel() {
+    return std::min(GetSupportedSimdLevel(), (SimdLevel)s_limit.load(std::memory_order_relaxed));
+}
+
+void CpuFeatures::SetSimdLimit(SimdLevel level) {
+    s_limit.store((int)level, std::memory_order_relaxed);
+}
+
+const char* CpuFeatures::GetSimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SCALAR: return "scalar";
+        case SimdLevel::SSE2:   return "SSE2";
+        case SimdLevel::AVX:    return "AVX";
+        case SimdLevel::AVX2:   return "AVX2";
+    }
+    return "?";
+}
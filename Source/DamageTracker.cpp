@@ -0,0 +1,88 @@
+#include "../Include/DamageTracker.h"
+
+DamageTracker::DamageTracker()
+    : m_screenWidth(0), m_screenHeight(0), m_fullRedraw(true), m_regionsFull(true) {
+}
+
+void DamageTracker::SetScreenSize(int width, int height) {
+    m_screenWidth = width;
+    m_screenHeight = height;
+    m_fullRedraw = true;
+}
+
+void DamageTracker::AddRect(const SDL_FRect& rect) {
+    // Snap outward to whole pixels and clip to the screen
+    int left = std::max(0, (int)std::floor(rect.x));
+    int top = std::max(0, (int)std::floor(rect.y));
+    int right = std::min(m_screenWidth, (int)std::ceil(rect.x + rect.w));
+    int bottom = std::min(m_screenHeight, (int)std::ceil(rect.y + rect.h));
+
+    if (right <= left || bottom <= top) {
+        return;
+    }
+
+    m_current.push_back({left, top, right - left, bottom - top});
+}
+
+void DamageTracker::Resolve() {
+    m_regions.clear();
+    m_regionsFull = m_fullRedraw;
+
+    if (!m_regionsFull) {
+        m_regions.insert(m_regions.end(), m_previous.begin(), m_previous.end());
+        m_regions.insert(m_regions.end(), m_current.begin(), m_current.end());
+        MergeRegions();
+
+        // Past a point, many small updates cost more than one big one
+        long long damagedArea = 0;
+        for (const SDL_Rect& r : m_regions) {
+            damagedArea += (long long)r.w * r.h;
+        }
+        long long screenArea = (long long)m_screenWidth * m_screenHeight;
+        if (m_regions.size() > MAX_REGIONS || damagedArea * 2 > screenArea) {
+            m_regionsFull = true;
+        }
+    }
+
+    if (m_regionsFull) {
+        m_regions.clear();
+        m_regions.push_back({0, 0, m_screenWidth, m_screenHeight});
+    }
+
+    m_previous.swap(m_current);
+    m_current.clear();
+    m_fullRedraw = false;
+}
+
+void DamageTracker::MergeRegions() {
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < m_regions.size(); ++i) {
+            for (size_t j = i + 1; j < m_regions.size(); ) {
+                if (Overlaps(m_regions[i], m_regions[j])) {
+                    m_regions[i] = Union(m_regions[i], m_regions[j]);
+                    m_regions[j] = m_regions.back();
+                    m_regions.pop_back();
+                    merged = true;
+                } else {
+                    ++j;
+                }
+            }
+        }
+    }
+}
+
+bool DamageTracker::Overlaps(const SDL_Rect& a, const SDL_Rect& b) {
+    // Touching rects count as overlapping so neighbours coalesce
+    return a.x <= b.x + b.w && b.x <= a.x + a.w &&
+           a.y <= b.y + b.h && b.y <= a.y + a.h;
+}
+
+SDL_Rect DamageTracker::Union(const SDL_Rect& a, const SDL_Rect& b) {
+    int left = std::min(a.x, b.x);
+    int top = std::min(a.y, b.y);
+    int right = std::max(a.x + a.w, b.x + b.w);
+    int bottom = std::max(a.y + a.h, b.y + b.h);
+    return {left, top, right - left, bottom - top};
+}
@@ -0,0 +1,219 @@
+#include "../Include/EventScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static int LowestBit(uint64_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+EventScheduler::EventScheduler(double resolution)
+    : m_freeList(NONE), m_resolution(resolution > 0.0 ? resolution : 1.0 / 1000.0),
+      m_time(0.0), m_tick(0), m_nextSequence(0), m_pending(0) {
+    for (int level = 0; level < LEVELS; ++level) {
+        std::fill(m_slots[level], m_slots[level] + SLOTS, NONE);
+        m_occupied[level] = 0;
+    }
+}
+
+EventScheduler::EventId EventScheduler::At(double time, Callback callback) {
+    uint32_t index = Allocate();
+    Event& event = m_events[index];
+    event.Time = time;
+    event.Tick = time > 0.0 ? (uint64_t)std::floor(time / m_resolution) : 0;
+    event.Sequence = m_nextSequence++;
+    event.Active = true;
+    event.Function = std::move(callback);
+    ++m_pending;
+
+    Insert(index);
+    return ((EventId)event.Generation << 32) | (index + 1);
+}
+
+bool EventScheduler::Cancel(EventId id) {
+    uint32_t index = (uint32_t)(id & 0xFFFFFFFFu) - 1;
+    if (id == 0 || index >= m_events.size()) {
+        return false;
+    }
+
+    Event& event = m_events[index];
+    if (!event.Active || event.Generation != (uint32_t)(id >> 32)) {
+        return false;
+    }
+
+    // Left in its slot and freed when the wheel reaches it
+    event.Active = false;
+    event.Function = nullptr;
+    --m_pending;
+    return true;
+}
+
+void EventScheduler::AdvanceTo(double time) {
+    if (time > m_time) {
+        m_time = time;
+    }
+
+    uint64_t target = m_time > 0.0 ? (uint64_t)std::floor(m_time / m_resolution) : 0;
+    while (m_tick < target) {
+        // Jumps straight to the next tick with something to do rather than
+        // stepping through empty ones
+        uint64_t next = m_pending > 0 ? NextOccupiedTick() : NO_TICK;
+        if (next > target) {
+            m_tick = target;
+            break;
+        }
+        m_tick = next;
+
+        // Entering a new block of a level's range pulls that block's slot
+        // down into the levels below. Higher levels go first so what they
+        // hand down is cascaded again if it lands in a block starting now.
+        if ((m_tick & ((1ull << (LEVEL_BITS * LEVELS)) - 1)) == 0 && !m_overflow.empty()) {
+            std::vector<uint32_t> overflow;
+            overflow.swap(m_overflow);
+            for (uint32_t index : overflow) {
+                Insert(index);
+            }
+        }
+
+        for (int level = LEVELS - 1; level > 0; --level) {
+            if ((m_tick & ((1ull << (LEVEL_BITS * level)) - 1)) == 0) {
+                Cascade(level);
+            }
+        }
+
+        uint32_t slotIndex = (uint32_t)(m_tick & (SLOTS - 1));
+        for (uint32_t index = m_slots[0][slotIndex]; index != NONE;) {
+            uint32_t nextIndex = m_events[index].Next;
+            m_due.push_back(index);
+            index = nextIndex;
+        }
+        m_slots[0][slotIndex] = NONE;
+        m_occupied[0] &= ~(1ull << slotIndex);
+    }
+
+    // Callbacks can add events that are already due, so repeat until a
+    // pass fires nothing
+    bool fired = true;
+    while (fired && !m_due.empty()) {
+        fired = false;
+        m_firing.swap(m_due);
+        std::sort(m_firing.begin(), m_firing.end(), [this](uint32_t a, uint32_t b) {
+            const Event& left = m_events[a];
+            const Event& right = m_events[b];
+            return left.Time != right.Time ? left.Time < right.Time : left.Sequence < right.Sequence;
+        });
+
+        for (uint32_t index : m_firing) {
+            Event& event = m_events[index];
+            if (!event.Active) {
+                Free(index);
+                continue;
+            }
+
+            if (event.Time > m_time) {
+                // Later within the current tick
+                m_due.push_back(index);
+                continue;
+            }
+
+            // The callback may schedule events, which can move m_events
+            Callback callback = std::move(event.Function);
+            event.Active = false;
+            --m_pending;
+            Free(index);
+
+            callback();
+            fired = true;
+        }
+        m_firing.clear();
+    }
+}
+
+uint64_t EventScheduler::NextOccupiedTick() const {
+    // Slots at or before the clock's own position in each level have
+    // already been visited or cascaded, so only later ones count. The
+    // first level with one holds the earliest.
+    for (int level = 0; level < LEVELS; ++level) {
+        uint32_t position = (uint32_t)((m_tick >> (LEVEL_BITS * level)) & (SLOTS - 1));
+        uint64_t later = position == SLOTS - 1 ? 0 : m_occupied[level] & (~0ull << (position + 1));
+        if (later != 0) {
+            int shift = LEVEL_BITS * (level + 1);
+            uint64_t blockStart = (m_tick >> shift) << shift;
+            return blockStart + ((uint64_t)LowestBit(later) << (LEVEL_BITS * level));
+        }
+    }
+
+    if (!m_overflow.empty()) {
+        int shift = LEVEL_BITS * LEVELS;
+        return ((m_tick >> shift) + 1) << shift;
+    }
+    return NO_TICK;
+}
+
+void EventScheduler::Insert(uint32_t index) {
+    Event& event = m_events[index];
+    if (event.Tick <= m_tick) {
+        m_due.push_back(index);
+        return;
+    }
+
+    // The lowest level whose block of ticks holds both now and the event
+    for (int level = 0; level < LEVELS; ++level) {
+        int shift = LEVEL_BITS * (level + 1);
+        if ((event.Tick >> shift) == (m_tick >> shift)) {
+            uint32_t slotIndex = (uint32_t)((event.Tick >> (LEVEL_BITS * level)) & (SLOTS - 1));
+            event.Next = m_slots[level][slotIndex];
+            m_slots[level][slotIndex] = index;
+            m_occupied[level] |= 1ull << slotIndex;
+            return;
+        }
+    }
+
+    m_overflow.push_back(index);
+}
+
+void EventScheduler::Cascade(int level) {
+    uint32_t slotIndex = (uint32_t)((m_tick >> (LEVEL_BITS * level)) & (SLOTS - 1));
+    uint32_t index = m_slots[level][slotIndex];
+    m_slots[level][slotIndex] = NONE;
+    m_occupied[level] &= ~(1ull << slotIndex);
+
+    while (index != NONE) {
+        uint32_t next = m_events[index].Next;
+        if (m_events[index].Active) {
+            Insert(index);
+        } else {
+            Free(index);
+        }
+        index = next;
+    }
+}
+
+uint32_t EventScheduler::Allocate() {
+    if (m_freeList != NONE) {
+        uint32_t index = m_freeList;
+        m_freeList = m_events[index].Next;
+        return index;
+    }
+
+    m_events.push_back(Event());
+    m_events.back().Generation = 0;
+    return (uint32_t)(m_events.size() - 1);
+}
+
+void EventScheduler::Free(uint32_t index) {
+    Event& event = m_events[index];
+    event.Function = nullptr;
+    ++event.Generation;
+    event.Next = m_freeList;
+    m_freeList = index;
+}
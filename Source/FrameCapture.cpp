@@ -0,0 +1,165 @@
+#include "../Include/FrameCapture.h"
+#include "../Include/FileController.h"
+#include "../Include/TGAReader.h"
+#include "../Include/Log.h"
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
+FrameCapture::FrameCapture()
+    : m_format(Format::TGA), m_width(0), m_height(0), m_head(0), m_tail(0), m_count(0),
+      m_stopping(false), m_submitted(0), m_written(0), m_dropped(0) {
+}
+
+FrameCapture::~FrameCapture() {
+    Stop();
+}
+
+bool FrameCapture::Start(const std::string& path, Format format, int width, int height, size_t ringSize) {
+    Stop();
+
+    if (format == Format::TGA) {
+        std::error_code error;
+        std::filesystem::create_directories(path, error);
+        if (error) {
+            LOG_ERROR("Failed to create capture directory %s: %s", path.c_str(), error.message().c_str());
+            return false;
+        }
+    } else {
+        m_stream.open(path, std::ios::binary);
+        if (!m_stream.is_open()) {
+            LOG_ERROR("Failed to create capture file: %s", path.c_str());
+            return false;
+        }
+    }
+
+    m_path = path;
+    m_format = format;
+    m_width = width;
+    m_height = height;
+
+    // All frame memory is allocated up front
+    m_slots.resize(std::max<size_t>(ringSize, 2));
+    for (Slot& slot : m_slots) {
+        slot.Pixels.resize((size_t)width * height * 4);
+    }
+
+    m_head = m_tail = m_count = 0;
+    m_submitted = m_written = m_dropped = 0;
+    m_stopping = false;
+    m_writer = std::thread(&FrameCapture::WriterThread, this);
+    return true;
+}
+
+void FrameCapture::Stop() {
+    if (!m_writer.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_ready.notify_one();
+    m_writer.join();
+
+    if (m_stream.is_open()) {
+        m_stream.close();
+    }
+
+    if (m_dropped > 0) {
+        LOG_INFO("Captured %zu frames to %s (%zu dropped)", m_written, m_path.c_str(), m_dropped);
+    } else {
+        LOG_INFO("Captured %zu frames to %s", m_written, m_path.c_str());
+    }
+
+    m_slots.clear();
+    m_slots.shrink_to_fit();
+}
+
+bool FrameCapture::CanSubmit() {
+    if (!IsActive()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_count == m_slots.size()) {
+        m_submitted++;
+        m_dropped++;
+        return false;
+    }
+    return true;
+}
+
+bool FrameCapture::Submit(const void* pixels, int pitch, int width, int height) {
+    if (!IsActive()) {
+        return false;
+    }
+    if (width != m_width || height != m_height) {
+        LOG_ERROR("Capture frame is %dx%d, expected %dx%d", width, height, m_width, m_height);
+        return false;
+    }
+
+    size_t frame = m_submitted++;
+    size_t index;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_count == m_slots.size()) {
+            m_dropped++;
+            return false;
+        }
+        index = m_head;
+    }
+
+    // The head slot isn't visible to the writer until it's published below
+    Slot& slot = m_slots[index];
+    const size_t rowBytes = (size_t)m_width * 4;
+    for (int y = 0; y < m_height; ++y) {
+        memcpy(slot.Pixels.data() + y * rowBytes,
+               static_cast<const unsigned char*>(pixels) + (size_t)y * pitch, rowBytes);
+    }
+    slot.Frame = frame;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_head = (m_head + 1) % m_slots.size();
+        m_count++;
+    }
+    m_ready.notify_one();
+    return true;
+}
+
+void FrameCapture::WriterThread() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_ready.wait(lock, [this]() { return m_count > 0 || m_stopping; });
+        if (m_count == 0) {
+            return; // Stopping with nothing left to write
+        }
+
+        const Slot& slot = m_slots[m_tail];
+        lock.unlock();
+        bool written = WriteFrame(slot);
+        lock.lock();
+
+        m_tail = (m_tail + 1) % m_slots.size();
+        m_count--;
+        if (written) {
+            m_written++;
+        }
+    }
+}
+
+bool FrameCapture::WriteFrame(const Slot& slot) {
+    if (m_format == Format::RAW) {
+        m_stream.write(reinterpret_cast<const char*>(slot.Pixels.data()), slot.Pixels.size());
+        return m_stream.good();
+    }
+
+    // Frame numbers count dropped frames too, so gaps show where they were
+    std::ostringstream name;
+    name << m_path << "/frame_" << std::setw(6) << std::setfill('0') << slot.Frame << ".tga";
+
+    TGAReader::EncodeTGA(slot.Pixels.data(), m_width, m_height, m_encoded);
+    return FileController::GetInstance()->WriteFile(name.str(), m_encoded.data(), m_encoded.size());
+}
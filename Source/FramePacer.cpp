@@ -0,0 +1,97 @@
+#include "../Include/FramePacer.h"
+#include <iomanip>
+#include <thread>
+
+// Always finish the wait by spinning for at least this long
+static const double SPIN_WINDOW_MS = 0.2;
+
+// Starting guess for how late the OS wakes us; learned from then on
+static const double INITIAL_SLEEP_MARGIN_MS = 1.0;
+
+// A single long preemption shouldn't leave us spinning for whole frames
+static const double MAX_SLEEP_MARGIN_MS = 4.0;
+
+FramePacer::FramePacer()
+    : m_targetRate(0), m_period(0), m_nextFrame(0), m_spinWindow(0), m_sleepMargin(0), m_ticksPerMs(0),
+      m_frames(0), m_missedFrames(0), m_jitterSum(0), m_jitterMax(0), m_waitMs(0), m_sleepMs(0) {
+}
+
+void FramePacer::SetTargetRate(float hz) {
+    m_ticksPerMs = SDL_GetPerformanceFrequency() / 1000.0;
+    m_targetRate = hz > 0.0f ? hz : 0.0f;
+    m_period = hz > 0.0f ? (Uint64)(SDL_GetPerformanceFrequency() / (double)hz) : 0;
+    m_nextFrame = 0;
+    m_spinWindow = (Uint64)(SPIN_WINDOW_MS * m_ticksPerMs);
+    m_sleepMargin = (Uint64)(INITIAL_SLEEP_MARGIN_MS * m_ticksPerMs);
+}
+
+void FramePacer::Sleep(Uint64 ticks) {
+    // SDL uses high-resolution waitable timers on Windows and nanosleep elsewhere
+    SDL_DelayNS((Uint64)(ticks / m_ticksPerMs * 1000000.0));
+}
+
+void FramePacer::Wait() {
+    if (m_period == 0) {
+        return;
+    }
+
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (m_nextFrame == 0) {
+        m_nextFrame = now + m_period;
+    }
+
+    Uint64 deadline = m_nextFrame;
+    Uint64 waitStart = now;
+    if (now < deadline) {
+        Uint64 remaining = deadline - now;
+        if (remaining > m_spinWindow + m_sleepMargin) {
+            Uint64 request = remaining - m_spinWindow - m_sleepMargin;
+            Sleep(request);
+
+            Uint64 woke = SDL_GetPerformanceCounter();
+            Uint64 slept = woke - now;
+            Uint64 oversleep = slept > request ? slept - request : 0;
+            m_sleepMs += slept / m_ticksPerMs;
+            now = woke;
+
+            // Follow the OS up at once, back down slowly
+            if (oversleep > m_sleepMargin) {
+                m_sleepMargin = std::min(oversleep, (Uint64)(MAX_SLEEP_MARGIN_MS * m_ticksPerMs));
+            } else {
+                m_sleepMargin -= (m_sleepMargin - oversleep) / 16;
+            }
+        }
+
+        while (now < deadline) {
+            std::this_thread::yield();
+            now = SDL_GetPerformanceCounter();
+        }
+    }
+    m_waitMs += (now - waitStart) / m_ticksPerMs;
+
+    double late = (now - deadline) / m_ticksPerMs;
+    ++m_frames;
+    m_jitterSum += late;
+    m_jitterMax = std::max(m_jitterMax, late);
+
+    // Late by more than a frame: start a new schedule rather than catch up
+    if (now - deadline >= m_period) {
+        ++m_missedFrames;
+        m_nextFrame = now + m_period;
+    } else {
+        m_nextFrame = deadline + m_period;
+    }
+}
+
+void FramePacer::PrintStats(std::ostream& out) const {
+    if (m_period == 0 || m_frames == 0) {
+        return;
+    }
+
+    out << std::fixed << std::setprecision(3)
+        << "Frame pacing: " << m_targetRate << " Hz, " << m_frames << " frames, start jitter mean "
+        << m_jitterSum / m_frames << " ms, max " << m_jitterMax << " ms, " << m_missedFrames << " missed; slept "
+        << std::setprecision(1) << (m_waitMs > 0.0 ? 100.0 * m_sleepMs / m_waitMs : 0.0)
+        << "% of wait time, sleep margin " << std::setprecision(3) << m_sleepMargin / m_ticksPerMs << " ms"
+        << std::endl;
+}
@@ -1,13 +1,24 @@
 #include "../Include/GameController.h"
 #include "../Include/Level1.h"
-#include "../Include/Level2.h"
+#include "../Include/StressLevel.h"
 #include "../Include/AssetController.h"
+#include "../Include/FileController.h"
+#include "../Include/ResidencyManager.h"
+#include "../Include/AnimationSystem.h"
+#include "../Include/MemoryTracker.h"
+#include "../Include/Log.h"
+#include "../Include/Metrics.h"
 #include <sstream>
 #include <iomanip>
 
 GameController::GameController()
-    : m_currentLevel(nullptr), m_renderer(nullptr), m_running(false),
-      m_lastTime(0), m_deltaTime(0), m_fps(0), m_frameCount(0), m_fpsTimer(0) {
+    : m_world(nullptr), m_randomSeed(0), m_currentLevel(nullptr), m_nextLevel(nullptr), m_nextLevelReady(false), m_renderer(nullptr),
+      m_pipelining(true), m_simulationPending(false), m_simulationStopping(false), m_running(false),
+      m_damageTracking(false), m_softwareRaster(false), m_headless(false), m_rasterThreads(0),
+      m_stressTest(false), m_hotReload(false), m_memoryStats(false),
+      m_cpuBudget(64 * 1024 * 1024), m_textureBudget(64 * 1024 * 1024),
+      m_captureFormat(FrameCapture::Format::TGA), m_frameRateLimit(-1.0f), m_perfTolerance(0.25), m_perfCheckTiming(false), m_exitCode(0),
+      m_lastTime(0), m_deltaTime(0), m_fixedStep(0), m_fixedFrameTime(0), m_stepAccumulator(0), m_fps(0), m_frameCount(0), m_fpsTimer(0) {
 }
 
 GameController::~GameController() {
@@ -15,33 +26,88 @@ GameController::~GameController() {
 }
 
 void GameController::Initialize() {
-    // Initialize object pools
-    Warrior::Pool = new ObjectPool<Warrior>(20);
-    Rock::Pool = new ObjectPool<Rock>(20);
-    Texture::Pool = new ObjectPool<Texture>(10);
+    // Initialize object pools (stress runs pre-size them to the population)
+    size_t warriorPoolSize = m_stressTest ? std::max<size_t>(20, m_stressConfig.Warriors) : 20;
+    size_t rockPoolSize = m_stressTest ? std::max<size_t>(20, m_stressConfig.Rocks) : 20;
+    m_world = new World(warriorPoolSize, rockPoolSize, m_randomSeed, AnimationSystem::GetInstance());
+    World::SetDefault(m_world);
+    Texture::Pool = new ObjectPool<Texture>(10, "Texture");
 
     // Initialize renderer
+    MemoryScope rendererScope(MemoryTag::RENDERER);
     m_renderer = Renderer::GetInstance();
+    m_renderer->SetDamageTracking(m_damageTracking);
+    m_renderer->SetSoftwareRaster(m_softwareRaster);
+    m_renderer->SetHeadless(m_headless);
+    m_renderer->SetRasterThreads(m_rasterThreads);
     if (!m_renderer->Initialize("SDLLevels - Game Engine Midterm", 1920, 1080)) {
-        std::cerr << "Failed to initialize renderer!" << std::endl;
+        LOG_ERROR("Failed to initialize renderer!");
         return;
     }
 
+    if (!m_capturePath.empty() && m_capture.Start(m_capturePath, m_captureFormat, 1920, 1080)) {
+        m_renderer->SetCapture(&m_capture);
+    }
+
+    MemoryScope assetScope(MemoryTag::ASSETS);
+    ResidencyManager::GetInstance()->SetBudgets(m_cpuBudget, m_textureBudget);
+
     // Initialize asset controller
-    AssetController::GetInstance()->Initialize(10 * 1024 * 1024); // 10 MB
+    // Address space only; pages are committed as assets load
+    AssetController::GetInstance()->Initialize(sizeof(void*) >= 8 ? (size_t)4 << 30 : (size_t)256 << 20);
+
+    // Serve assets from the packed archive when one was built; hot reload
+    // works on loose files, so development runs skip the archive
+    if (m_hotReload) {
+        AssetController::GetInstance()->StartWatching("Assets");
+    } else {
+        FileController::GetInstance()->MountArchive("Assets.pak");
+    }
+
+    // Without an archive, saved asset ids resolve through the loose files
+    if (!FileController::GetInstance()->IsArchiveMounted()) {
+        AssetController::GetInstance()->RegisterPaths("Assets");
+    }
+
+    // Load animation clips (and their sprite sheets)
+    if (!AnimationSystem::GetInstance()->LoadClips("Assets/Animations/clips.txt")) {
+        LOG_ERROR("Failed to load animation clips!");
+    }
 
-    // Create Level 1
-    m_currentLevel = new Level1();
+    // Create Level 1, or the stress scenario
+    MemoryScope levelScope(MemoryTag::LEVELS);
+    if (m_stressTest) {
+        m_currentLevel = new StressLevel(m_stressConfig);
+    } else {
+        m_currentLevel = new Level1();
+    }
     m_currentLevel->Initialize();
+    m_currentLevel->Start();
+    m_world->GetTransforms()->Update();
+    StartPreload();
+
+    if (m_pipelining) {
+        m_simulationThread = std::thread(&GameController::SimulationLoop, this);
+    }
+
+    // Headless runs are benchmarks and batch jobs; let them run flat out
+    m_pacer.SetTargetRate(m_frameRateLimit >= 0.0f ? m_frameRateLimit : (m_headless ? 0.0f : 60.0f));
 
     m_running = true;
     m_lastTime = SDL_GetPerformanceCounter();
 }
 
 void GameController::RunGame() {
+    Uint64 startTime = SDL_GetPerformanceCounter();
     Initialize();
+    m_perf.RecordLoad("startup", GetElapsedMs(startTime));
+
+    // Startup's allocations aren't a frame's; start the first frame's count from zero
+    MemoryTracker::EndFrame();
 
     while (m_running) {
+        m_perf.BeginFrame();
+
         // Calculate delta time
         Uint64 currentTime = SDL_GetPerformanceCounter();
         m_deltaTime = (float)((currentTime - m_lastTime) / (double)SDL_GetPerformanceFrequency());
@@ -51,6 +117,9 @@ void GameController::RunGame() {
         if (m_deltaTime > 0.1f) {
             m_deltaTime = 0.1f;
         }
+        if (m_fixedFrameTime > 0.0f) {
+            m_deltaTime = m_fixedFrameTime;
+        }
 
         // Handle events
         while (SDL_PollEvent(&m_event)) {
@@ -65,57 +134,267 @@ void GameController::RunGame() {
         }
 
         Update(m_deltaTime);
-        Render();
+
+        if (m_pipelining) {
+            // The next frame is simulated and recorded while this thread
+            // draws the one recorded last time round
+            StartSimulation();
+            Render();
+            WaitForSimulation();
+            m_renderQueue.Swap();
+        } else {
+            Simulate(m_deltaTime);
+            m_renderQueue.Swap();
+            Render();
+        }
+
+        MemoryTracker::EndFrame();
+        m_perf.EndFrame();
+        UpdateMetrics();
 
         // Check quit conditions
         if (m_currentLevel && m_currentLevel->ShouldQuit()) {
             m_running = false;
         }
+
+        if (m_running) {
+            m_pacer.Wait();
+        }
+    }
+
+    // The last frame recorded hasn't been drawn yet
+    if (m_pipelining) {
+        Render();
     }
 
     Shutdown();
 }
 
 void GameController::Update(float deltaTime) {
+    // Runs on the main thread while the simulation thread is idle, so it
+    // may touch textures, the renderer and the level list
     CalculateFPS(deltaTime);
+    ResidencyManager::GetInstance()->BeginFrame();
+
+    if (m_hotReload) {
+        ApplyAssetReloads();
+    }
 
     if (m_currentLevel) {
-        m_currentLevel->Update(deltaTime);
+        PollPreload();
         HandleLevelTransition();
     }
 }
 
+void GameController::Simulate(float deltaTime) {
+    if (m_currentLevel && m_fixedStep <= 0.0f) {
+        Step(deltaTime);
+    } else if (m_currentLevel) {
+        // Swept collision keeps coarse steps correct, so the simulation
+        // rate can sit well below the frame rate. Transitions happen on the
+        // main thread, so steps past one wait in the accumulator for the
+        // next level.
+        m_stepAccumulator += deltaTime;
+        while (m_stepAccumulator >= m_fixedStep && !m_currentLevel->ShouldQuit() &&
+               !(m_nextLevel && m_currentLevel->ShouldTransition())) {
+            Step(m_fixedStep);
+            m_stepAccumulator -= m_fixedStep;
+        }
+    }
+
+    Record();
+}
+
+void GameController::Step(float deltaTime) {
+    MemoryScope scope(MemoryTag::LEVELS);
+    m_world->GetAnimation()->Update(deltaTime);
+    m_currentLevel->Update(deltaTime);
+
+    // Spawns and reloads late in the step leave nodes queued; settle them
+    // here so the transition checks and Record() read current transforms
+    m_world->GetTransforms()->Update();
+}
+
+void GameController::Record() {
+    MemoryScope scope(MemoryTag::RENDERER);
+    FramePacket* packet = m_renderQueue.GetRecordPacket();
+    if (!m_currentLevel) {
+        packet->Reset({0, 0, 0, 255});
+        return;
+    }
+
+    packet->Reset(m_currentLevel->GetBackgroundColor());
+    m_currentLevel->Render(packet);
+    RenderUI(packet);
+}
+
 void GameController::Render() {
-    if (m_currentLevel) {
-        m_renderer->ClearWithColor(m_currentLevel->GetBackgroundColor());
-        m_currentLevel->Render(m_renderer);
-        RenderUI();
-        m_renderer->Present();
+    const FramePacket* packet = m_renderQueue.GetDrawPacket();
+    if (!packet) {
+        return;
+    }
+
+    MemoryScope scope(MemoryTag::RENDERER);
+    m_renderer->RenderPacket(*packet);
+    ResidencyManager::GetInstance()->EnforceBudgets(m_renderer);
+}
+
+void GameController::StartSimulation() {
+    {
+        std::lock_guard<std::mutex> lock(m_simulationMutex);
+        m_simulationPending = true;
+    }
+    m_simulationWake.notify_one();
+}
+
+void GameController::WaitForSimulation() {
+    std::unique_lock<std::mutex> lock(m_simulationMutex);
+    m_simulationDone.wait(lock, [this]() { return !m_simulationPending; });
+}
+
+void GameController::SimulationLoop() {
+    std::unique_lock<std::mutex> lock(m_simulationMutex);
+
+    for (;;) {
+        m_simulationWake.wait(lock, [this]() { return m_simulationStopping || m_simulationPending; });
+        if (m_simulationStopping) {
+            return;
+        }
+
+        lock.unlock();
+        Simulate(m_deltaTime);
+        lock.lock();
+
+        m_simulationPending = false;
+        m_simulationDone.notify_one();
+    }
+}
+
+void GameController::StopSimulationThread() {
+    if (!m_simulationThread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_simulationMutex);
+        m_simulationStopping = true;
     }
+    m_simulationWake.notify_one();
+    m_simulationThread.join();
 }
 
 void GameController::Shutdown() {
+    StopSimulationThread();
+
+    // Runs from RunGame() and again from the destructor
+    if (!m_renderer) {
+        return;
+    }
+
+    // The reports below go straight to stdout, after what's been logged
+    Log::Flush();
+    FinishPerfReport();
+    m_pacer.PrintStats(std::cout);
+
+    if (m_nextLevel) {
+        if (m_nextLevelLoad.valid()) {
+            m_nextLevelLoad.wait();
+        }
+        delete m_nextLevel;
+        m_nextLevel = nullptr;
+    }
+    std::vector<Texture*>().swap(m_nextLevelTextures);
+    m_renderQueue.Clear();
+
     if (m_currentLevel) {
         delete m_currentLevel;
         m_currentLevel = nullptr;
     }
 
-    AssetController::DestroyInstance();
+    // Flushes frames still waiting to be written
+    m_capture.Stop();
+
     Renderer::DestroyInstance();
+    m_renderer = nullptr;
 
     // Clean up object pools
-    if (Warrior::Pool) {
-        delete Warrior::Pool;
-        Warrior::Pool = nullptr;
-    }
-    if (Rock::Pool) {
-        delete Rock::Pool;
-        Rock::Pool = nullptr;
-    }
+    delete m_world;
+    m_world = nullptr;
+
+    // Entities have released their instances; clip textures return to Texture::Pool
+    AnimationSystem::DestroyInstance();
+
     if (Texture::Pool) {
         delete Texture::Pool;
         Texture::Pool = nullptr;
     }
+
+    // These outlive the textures they track
+    ResidencyManager::DestroyInstance();
+    AssetController::DestroyInstance();
+    FileController::DestroyInstance();
+
+    if (m_memoryStats) {
+        MemoryTracker::PrintStats(std::cout);
+    }
+
+    // Everything tagged has been torn down by now
+    MemoryTracker::ReportLeaks(std::cerr);
+}
+
+void GameController::FinishPerfReport() {
+    if (!m_perfReportPath.empty()) {
+        if (m_perf.WriteReport(m_perfReportPath)) {
+            std::cout << "Performance report written to " << m_perfReportPath << std::endl;
+        } else {
+            m_exitCode = 1;
+        }
+    }
+
+    if (!m_perfBaselinePath.empty() && !m_perf.CheckBaseline(m_perfBaselinePath, m_perfTolerance, m_perfCheckTiming)) {
+        m_exitCode = 1;
+    }
+}
+
+void GameController::UpdateMetrics() {
+    Metrics::Add(Metric::FRAMES);
+
+    ObjectPool<Warrior>* warriors = m_world->GetWarriorPool();
+    ObjectPool<Rock>* rocks = m_world->GetRockPool();
+    Metrics::Set(Metric::WARRIOR_POOL_TOTAL, warriors->GetTotalSize());
+    Metrics::Set(Metric::WARRIOR_POOL_AVAILABLE, warriors->GetAvailableSize());
+    Metrics::Set(Metric::ROCK_POOL_TOTAL, rocks->GetTotalSize());
+    Metrics::Set(Metric::ROCK_POOL_AVAILABLE, rocks->GetAvailableSize());
+    Metrics::Set(Metric::WARRIORS, warriors->GetTotalSize() - warriors->GetAvailableSize());
+    Metrics::Set(Metric::ROCKS, rocks->GetTotalSize() - rocks->GetAvailableSize());
+
+    size_t alive = 0;
+    if (m_currentLevel) {
+        for (Warrior* warrior : m_currentLevel->GetWarriors()) {
+            alive += warrior->IsAlive() ? 1 : 0;
+        }
+    }
+    Metrics::Set(Metric::WARRIORS_ALIVE, alive);
+
+    ResidencyManager* residency = ResidencyManager::GetInstance();
+    Metrics::Set(Metric::ASSET_STACK_USED, AssetController::GetInstance()->GetStackUsed());
+    Metrics::Set(Metric::TEXTURES, residency->GetTextures().size());
+    Metrics::Set(Metric::TEXTURE_CPU_BYTES, residency->GetCpuBytes());
+    Metrics::Set(Metric::TEXTURE_GPU_BYTES, m_renderer->GetTextureBytes());
+}
+
+double GameController::GetElapsedMs(Uint64 start) const {
+    return (SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+void GameController::ApplyAssetReloads() {
+    m_reloadedTextures.clear();
+    AssetController::GetInstance()->ApplyPendingReloads(m_reloadedTextures);
+
+    for (Texture* texture : m_reloadedTextures) {
+        m_renderer->RefreshTexture(texture);
+        AnimationSystem::GetInstance()->RefreshClips(texture);
+    }
 }
 
 void GameController::CalculateFPS(float deltaTime) {
@@ -126,44 +405,137 @@ void GameController::CalculateFPS(float deltaTime) {
         m_fps = m_frameCount / m_fpsTimer;
         m_frameCount = 0;
         m_fpsTimer = 0.0f;
+
+        if (m_memoryStats) {
+            MemoryTracker::PrintStats(std::cout);
+        }
     }
 }
 
-void GameController::RenderUI() {
+void GameController::RenderUI(FramePacket* packet) {
     if (!m_currentLevel) return;
 
     SDL_Color blueColor = {0, 0, 255, 255};
+    std::string fps, time, status;
+    {
+        // The packet's storage outlives the frame; these strings don't
+        MemoryScope scope(MemoryTag::TRANSIENT);
 
-    // FPS Label
-    std::ostringstream fpsStream;
-    fpsStream << "FPS: " << std::fixed << std::setprecision(1) << m_fps;
-    m_renderer->RenderText(fpsStream.str(), 10, 10, blueColor);
+        // FPS Label
+        std::ostringstream fpsStream;
+        fpsStream << "FPS: " << std::fixed << std::setprecision(1) << m_fps;
+        fps = fpsStream.str();
 
-    // Time Label
-    std::ostringstream timeStream;
-    timeStream << "Time: " << std::fixed << std::setprecision(2) << m_currentLevel->GetGameTime() << "s";
-    m_renderer->RenderText(timeStream.str(), 200, 10, blueColor);
+        // Time Label
+        std::ostringstream timeStream;
+        timeStream << "Time: " << std::fixed << std::setprecision(2) << m_currentLevel->GetGameTime() << "s";
+        time = timeStream.str();
+
+        // Status Label
+        std::ostringstream statusStream;
+        statusStream << "Status: " << (m_currentLevel->IsAutoSaved() ? "Saved" : "Not Saved");
+        status = statusStream.str();
+    }
 
-    // Status Label
-    std::string status = m_currentLevel->IsAutoSaved() ? "Saved" : "Not Saved";
-    std::ostringstream statusStream;
-    statusStream << "Status: " << status;
-    m_renderer->RenderText(statusStream.str(), 400, 10, blueColor);
+    packet->RenderText(fps, 10, 10, blueColor);
+    packet->RenderText(time, 200, 10, blueColor);
+    packet->RenderText(status, 400, 10, blueColor);
 }
 
-void GameController::HandleLevelTransition() {
-    if (m_currentLevel && m_currentLevel->ShouldTransition()) {
-        if (m_currentLevel->GetLevelNumber() == 1) {
-            // Transition to Level 2
-            std::vector<Warrior*> warriors = m_currentLevel->GetWarriors();
-            
-            delete m_currentLevel;
-            
-            Level2* level2 = new Level2(warriors);
-            level2->Initialize();
-            m_currentLevel = level2;
-
-            std::cout << "Transitioned to Level 2" << std::endl;
+void GameController::StartPreload() {
+    m_nextLevel = m_currentLevel->CreateNextLevel();
+    m_nextLevelReady = false;
+    m_nextLevelTextures.clear();
+    if (!m_nextLevel) {
+        return;
+    }
+
+    LevelRequirements requirements;
+    m_nextLevel->GetRequirements(requirements);
+
+    // Sprite sheets decode on ResidencyManager's prefetch threads
+    AnimationSystem* animation = AnimationSystem::GetInstance();
+    for (AssetId clip : requirements.Clips) {
+        int clipId = animation->FindClip(clip);
+        if (clipId >= 0) {
+            Texture* texture = animation->GetClip(clipId).SheetTexture;
+            ResidencyManager::GetInstance()->Prefetch(texture);
+            m_nextLevelTextures.push_back(texture);
         }
     }
+
+    // Growing the pools now keeps allocation out of the transition frame
+    m_world->GetWarriorPool()->Reserve(requirements.Warriors);
+    m_world->GetRockPool()->Reserve(requirements.Rocks);
+
+    // Returns how long Preload() took, for the performance report
+    Level* level = m_nextLevel;
+    m_nextLevelLoad = std::async(std::launch::async, [this, level]() {
+        MemoryScope scope(MemoryTag::LEVELS);
+        Uint64 start = SDL_GetPerformanceCounter();
+        level->Preload();
+        return GetElapsedMs(start);
+    });
+}
+
+void GameController::PollPreload() {
+    if (!m_nextLevel) {
+        return;
+    }
+
+    if (m_nextLevelReady) {
+        // Keep the prepared textures from being evicted before the swap
+        for (Texture* texture : m_nextLevelTextures) {
+            texture->Touch(ResidencyManager::GetInstance()->GetFrame());
+        }
+        return;
+    }
+
+    if (m_nextLevelLoad.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    for (Texture* texture : m_nextLevelTextures) {
+        if (!texture->IsResident()) return;
+    }
+
+    FinishPreload();
+}
+
+void GameController::FinishPreload() {
+    Uint64 start = SDL_GetPerformanceCounter();
+    double preloadMs = m_nextLevelLoad.get();
+
+    // Upload the sheets and spawn entities now rather than in the transition frame
+    for (Texture* texture : m_nextLevelTextures) {
+        m_renderer->UploadTexture(texture);
+    }
+    m_nextLevel->Initialize();
+    m_nextLevelReady = true;
+
+    // Background and main-thread parts separately; wall time from start to
+    // ready mostly measures how many frames ran in between
+    std::string level = "level" + std::to_string(m_nextLevel->GetLevelNumber());
+    m_perf.RecordLoad(level + "_preload", preloadMs);
+    m_perf.RecordLoad(level + "_finish", GetElapsedMs(start));
+}
+
+void GameController::HandleLevelTransition() {
+    if (!m_currentLevel->ShouldTransition() || !m_nextLevel) {
+        return;
+    }
+
+    // Normally prepared by now; if not, finish the load in this frame
+    if (!m_nextLevelReady) {
+        FinishPreload();
+    }
+
+    m_nextLevel->TakeWarriors(m_currentLevel);
+    delete m_currentLevel;
+    m_currentLevel = m_nextLevel;
+    m_nextLevel = nullptr;
+    m_currentLevel->Start();
+    m_world->GetTransforms()->Update();
+
+    LOG_INFO("Transitioned to Level %d", m_currentLevel->GetLevelNumber());
+    StartPreload();
 }
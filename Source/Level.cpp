@@ -1,32 +1,146 @@
 #include "../Include/Level.h"
 #include "../Include/FileController.h"
+#include "../Include/Log.h"
+#include "../Include/Metrics.h"
+#include <limits>
 
 Level::Level(int levelNumber)
-    : m_levelNumber(levelNumber), m_gameTime(0.0f), m_autoSaved(false),
-      m_backgroundColor{0, 0, 0, 255} {
+    : m_world(World::GetCurrent()), m_levelNumber(levelNumber), m_gameTime(0.0f), m_autoSaved(false),
+      m_leadExited(false), m_backgroundColor{0, 0, 0, 255} {
 }
 
 Level::~Level() {
     // Warriors are managed by pool, don't delete
+    ReleaseAll(m_warriors, m_world->GetWarriorPool());
+}
+
+std::mt19937 Level::CreateRandomGenerator() const {
+    if (m_world->GetSeed() != 0) {
+        return std::mt19937(m_world->GetSeed() + m_levelNumber);
+    }
+
+    std::random_device rd;
+    return std::mt19937(rd());
+}
+
+void Level::AdvanceTime(float deltaTime) {
+    m_gameTime += deltaTime;
+    m_events.AdvanceTo(m_gameTime);
+}
+
+void Level::StartTask(Task task) {
+    m_tasks.push_back(std::move(task));
+    m_tasks.back().Start(m_events);
+}
+
+Task Level::RunAutoSave() {
+    if (m_world->IsAutoSaveEnabled()) {
+        co_await Seconds(AUTOSAVE_TIME);
+        AutoSave();
+    }
+}
+
+Task Level::WatchLeadWarrior() {
+    for (;;) {
+        Warrior* lead = m_warriors.empty() ? nullptr : m_warriors[0];
+        if (lead && lead->GetX() > EXIT_X) {
+            break;
+        }
+
+        // Sleeps for half the time the warrior needs to reach the edge at
+        // its current speed, so drift in the motion can't make the wake
+        // late; the last step or two before it crosses are checked one by
+        // one. A warrior that has stopped is waited out until it's
+        // released. Wakes early if another warrior takes the lead.
+        double timeout = std::numeric_limits<double>::infinity();
+        float speed = lead ? lead->GetVelocityX() : 0.0f;
+        if (speed > 0.0f) {
+            timeout = 0.5 * (EXIT_X - lead->GetX()) / speed;
+        }
+        co_await Condition(m_warriorsChanged, [this, lead] {
+            return (m_warriors.empty() ? nullptr : m_warriors[0]) != lead;
+        }, timeout);
+    }
+
+    m_leadExited = true;
+    m_warriorsChanged.Notify();
 }
 
 void Level::SaveToFile(const std::string& filename) {
     std::ofstream file(filename, std::ios::binary);
     if (!file.is_open()) {
-        std::cerr << "Failed to save level to: " << filename << std::endl;
+        LOG_ERROR("Failed to save level to: %s", filename.c_str());
         return;
     }
 
     Serialize(file);
+    Metrics::Add(Metric::SAVE_BYTES, (uint64_t)file.tellp());
     file.close();
 
-    std::cout << "Level saved to: " << filename << std::endl;
+    LOG_INFO("Level saved to: %s", filename.c_str());
+}
+
+// Entry/exit times of a moving interval [aMin, aMax] (relative velocity v)
+// against a fixed one; false if a stationary pair never overlaps
+static bool SweepAxis(float aMin, float aMax, float bMin, float bMax, float v,
+                      float& enter, float& exit) {
+    if (v == 0.0f) {
+        enter = -std::numeric_limits<float>::infinity();
+        exit = std::numeric_limits<float>::infinity();
+        return aMin < bMax && aMax > bMin;
+    }
+
+    float t0 = (bMin - aMax) / v;
+    float t1 = (bMax - aMin) / v;
+    enter = std::min(t0, t1);
+    exit = std::max(t0, t1);
+    return true;
+}
+
+bool Level::SweepAABB(Warrior* w, Rock* r, float deltaTime, float& timeOfImpact) {
+    // Work in the rock's frame from the start of the step: the warrior moves
+    // by the difference of both per-step motions
+    float vx = w->GetVelocityX();
+    float vy = -r->GetVelocityY();
+
+    float w_left = w->GetX() - w->GetVelocityX() * deltaTime;
+    float w_top = w->GetY();
+    float r_left = r->GetX();
+    float r_top = r->GetY() - r->GetVelocityY() * deltaTime;
+
+    float enterX, exitX, enterY, exitY;
+    if (!SweepAxis(w_left, w_left + w->GetWidth(), r_left, r_left + r->GetWidth(), vx, enterX, exitX) ||
+        !SweepAxis(w_top, w_top + w->GetHeight(), r_top, r_top + r->GetHeight(), vy, enterY, exitY)) {
+        return false;
+    }
+
+    float enter = std::max(std::max(enterX, enterY), 0.0f);
+    float exit = std::min(std::min(exitX, exitY), deltaTime);
+    if (enter >= exit) {
+        return false;
+    }
+
+    timeOfImpact = enter;
+    return true;
+}
+
+void Level::ResolveContacts(std::vector<Contact>& contacts) {
+    std::sort(contacts.begin(), contacts.end(),
+        [](const Contact& a, const Contact& b) { return a.Time < b.Time; });
+
+    for (const Contact& contact : contacts) {
+        if (contact.Target->IsAlive() && contact.Hit->IsActive()) {
+            contact.Target->StartDeathAnimation();
+            contact.Hit->SetActive(false);
+        }
+    }
+    contacts.clear();
 }
 
 Level* Level::LoadFromFile(const std::string& filename, int levelNumber) {
     std::ifstream file(filename, std::ios::binary);
     if (!file.is_open()) {
-        std::cerr << "Failed to load level from: " << filename << std::endl;
+        LOG_ERROR("Failed to load level from: %s", filename.c_str());
         return nullptr;
     }
 
@@ -61,9 +175,9 @@ void Level::Deserialize(std::istream& stream) {
     size_t warriorCount;
     stream.read(reinterpret_cast<char*>(&warriorCount), sizeof(size_t));
 
-    m_warriors.clear();
+    ReleaseAll(m_warriors, m_world->GetWarriorPool());
     for (size_t i = 0; i < warriorCount; ++i) {
-        Warrior* warrior = Warrior::Pool->GetResource();
+        Warrior* warrior = m_world->GetWarriorPool()->GetResource();
         warrior->Deserialize(stream);
         m_warriors.push_back(warrior);
     }
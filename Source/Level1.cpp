@@ -1,5 +1,6 @@
 #include "../Include/Level1.h"
-#include "../Include/Renderer.h"
+#include "../Include/Level2.h"
+#include "../Include/RenderQueue.h"
 
 Level1::Level1() : Level(1) {
     m_backgroundColor = {128, 128, 128, 255}; // Grey
@@ -9,8 +10,7 @@ Level1::~Level1() {
 }
 
 void Level1::Initialize() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937 gen = CreateRandomGenerator();
     std::uniform_real_distribution<float> speedDist(80.0f, 100.0f);
 
     // Spawn 10 warriors
@@ -20,60 +20,68 @@ void Level1::Initialize() {
         float speed = speedDist(gen);  // 80-100 px/s
         float animSpeed = 4.8f + ((speed - 80.0f) / 20.0f) * 1.2f;  // 4.8-6.0 fps
 
-        Warrior* warrior = Warrior::Pool->GetResource();
+        Warrior* warrior = m_world->GetWarriorPool()->GetResource();
         warrior->Initialize(xPos, yPos, speed, animSpeed, 1.8f);
         m_warriors.push_back(warrior);
     }
 
     m_gameTime = 0.0f;
     m_autoSaved = false;
+
+    StartTask(RunAutoSave());
 }
 
-void Level1::Update(float deltaTime) {
-    m_gameTime += deltaTime;
+void Level1::Start() {
+    // The watch reads the warriors spawned in Initialize()
+    m_world->GetTransforms()->Update();
 
-    // Update all warriors
-    for (Warrior* warrior : m_warriors) {
-        warrior->Update(deltaTime);
-    }
+    // Transition when the first warrior exits the screen
+    StartTask(WatchLeadWarrior());
+}
+
+void Level1::Update(float deltaTime) {
+    // Move all warriors, then bring world transforms up to date
+    m_world->GetMotion()->Update(deltaTime);
+    m_world->GetTransforms()->Update();
 
-    // Check auto-save
-    CheckAutoSave();
+    // Runs the autosave and the exit watch when they're due
+    AdvanceTime(deltaTime);
 }
 
-void Level1::Render(Renderer* renderer) {
+void Level1::Render(FramePacket* packet) {
     // Render all warriors
     for (Warrior* warrior : m_warriors) {
-        warrior->Render(renderer);
+        warrior->Render(packet);
     }
 }
 
-bool Level1::ShouldTransition() const {
-    // Transition when first warrior exits screen
-    if (!m_warriors.empty() && m_warriors[0]->GetX() > 1920.0f) {
-        return true;
-    }
-    return false;
+Level* Level1::CreateNextLevel() const {
+    return new Level2();
 }
 
-void Level1::CheckAutoSave() {
-    if (m_gameTime >= 5.0f && !m_autoSaved) {
-        SaveToFile("Level1.bin");
-        
-        // Reload to verify serialization
-        std::ifstream file("Level1.bin", std::ios::binary);
-        if (file.is_open()) {
-            Level1* reloaded = new Level1();
-            reloaded->Deserialize(file);
-            file.close();
-            
-            // Replace current state with reloaded
-            m_warriors = reloaded->GetWarriors();
-            m_gameTime = reloaded->GetGameTime();
-            m_autoSaved = true;
-            
-            delete reloaded;
-        }
+void Level1::AutoSave() {
+    if (m_autoSaved) {
+        return;
+    }
+
+    SaveToFile("Level1.bin");
+
+    // Reload to verify serialization
+    std::ifstream file("Level1.bin", std::ios::binary);
+    if (file.is_open()) {
+        Level1* reloaded = new Level1();
+        reloaded->Deserialize(file);
+        file.close();
+
+        // Replace current state with reloaded; the old warriors go back
+        // to the pool when reloaded is deleted. The reloaded ones are
+        // placed first, as the exit watch reads them when they take over.
+        m_world->GetTransforms()->Update();
+        TakeWarriors(reloaded);
+        m_gameTime = reloaded->GetGameTime();
+        m_autoSaved = true;
+
+        delete reloaded;
     }
 }
 
@@ -1,132 +1,144 @@
 #include "../Include/Level2.h"
-#include "../Include/Renderer.h"
+#include "../Include/RenderQueue.h"
+#include "../Include/Metrics.h"
 
-Level2::Level2(std::vector<Warrior*> warriors) : Level(2) {
+Level2::Level2() : Level(2), m_finished(false) {
     m_backgroundColor = {0, 128, 0, 255}; // Light Green
-    m_warriors = warriors;
 }
 
 Level2::~Level2() {
+    ReleaseAll(m_rocks, m_world->GetRockPool());
 }
 
-void Level2::Initialize() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
+void Level2::GetRequirements(LevelRequirements& requirements) const {
+    // Warriors start dying in this level, so their death sheet is needed too
+    requirements.Clips = {Rock::CLIP, Warrior::DEATH_CLIP};
+    requirements.Rocks = ROCK_COUNT;
+}
+
+void Level2::Preload() {
+    std::mt19937 gen = CreateRandomGenerator();
     std::uniform_real_distribution<float> speedDist(80.0f, 100.0f);
 
-    // Spawn 10 rocks
-    for (int i = 0; i < 10; i++) {
-        float xPos = 50.0f + (i * 100.0f);  // X: 50, 150, 250, ..., 950
-        float yPos = -100.0f;  // Start off-screen top
-        float speed = speedDist(gen);  // 80-100 px/s
-        float animSpeed = 4.8f + ((speed - 80.0f) / 20.0f) * 1.2f;  // 4.8-6.0 fps
+    m_rockSpawns.clear();
+    for (int i = 0; i < ROCK_COUNT; i++) {
+        RockSpawn spawn;
+        spawn.X = 50.0f + (i * 100.0f);  // X: 50, 150, 250, ..., 950
+        spawn.Y = -100.0f;  // Start off-screen top
+        spawn.Speed = speedDist(gen);  // 80-100 px/s
+        spawn.AnimSpeed = 4.8f + ((spawn.Speed - 80.0f) / 20.0f) * 1.2f;  // 4.8-6.0 fps
+        m_rockSpawns.push_back(spawn);
+    }
+}
 
-        Rock* rock = Rock::Pool->GetResource();
-        rock->Initialize(xPos, yPos, speed, animSpeed, 1.0f);
-        m_rocks.push_back(rock);
+void Level2::Initialize() {
+    if (m_rockSpawns.empty()) {
+        Preload();
     }
 
     m_gameTime = 0.0f;
     m_autoSaved = false;
-}
 
-void Level2::Update(float deltaTime) {
-    m_gameTime += deltaTime;
+    StartTask(RunAutoSave());
+}
 
-    // Update all warriors
-    for (Warrior* warrior : m_warriors) {
-        warrior->Update(deltaTime);
+void Level2::Start() {
+    // Spawn 10 rocks; spawned any earlier, they'd fall while Level 1 runs
+    for (const RockSpawn& spawn : m_rockSpawns) {
+        Rock* rock = m_world->GetRockPool()->GetResource();
+        rock->Initialize(spawn.X, spawn.Y, spawn.Speed, spawn.AnimSpeed, 1.0f);
+        m_rocks.push_back(rock);
     }
 
-    // Update all rocks
-    for (Rock* rock : m_rocks) {
-        rock->Update(deltaTime);
-    }
+    // The watch reads the warriors taken over from Level 1, so everything
+    // is placed first
+    m_world->GetTransforms()->Update();
+    StartTask(WatchLeadWarrior());
+    StartTask(WatchForEnd());
+}
+
+Task Level2::WatchForEnd() {
+    // Quit when the first warrior exits the screen or all warriors are
+    // dead. Update() releases warriors as their death animation ends, so
+    // none are left exactly when all have died.
+    co_await Condition(m_warriorsChanged, [this] { return m_leadExited || m_warriors.empty(); });
+    m_finished = true;
+}
+
+void Level2::Update(float deltaTime) {
+    // Move all warriors and rocks, then bring world transforms up to date
+    // for the collision checks
+    m_world->GetMotion()->Update(deltaTime);
+    m_world->GetTransforms()->Update();
 
     // Check collisions
-    CheckCollisions();
+    CheckCollisions(deltaTime);
 
     // Remove inactive rocks
-    m_rocks.erase(std::remove_if(m_rocks.begin(), m_rocks.end(),
-        [](Rock* r) { return !r->IsActive(); }), m_rocks.end());
+    ReleaseWhere(m_rocks, m_world->GetRockPool(), [](Rock* r) { return !r->IsActive(); });
 
     // Remove dead warriors (after death animation completes)
-    m_warriors.erase(std::remove_if(m_warriors.begin(), m_warriors.end(),
-        [](Warrior* w) { return w->IsDead(); }), m_warriors.end());
+    size_t warriorCount = m_warriors.size();
+    ReleaseWhere(m_warriors, m_world->GetWarriorPool(), [](Warrior* w) { return w->IsDead(); });
+
+    // Tasks woken from here on read warrior positions, so settle what the
+    // releases queued
+    m_world->GetTransforms()->Update();
+    if (m_warriors.size() != warriorCount) {
+        m_warriorsChanged.Notify();
+    }
 
-    // Check auto-save
-    CheckAutoSave();
+    // Runs the autosave and the exit watch when they're due
+    AdvanceTime(deltaTime);
 }
 
-void Level2::Render(Renderer* renderer) {
+void Level2::Render(FramePacket* packet) {
     // Render all warriors
     for (Warrior* warrior : m_warriors) {
-        warrior->Render(renderer);
+        warrior->Render(packet);
     }
 
     // Render all rocks
     for (Rock* rock : m_rocks) {
-        rock->Render(renderer);
-    }
-}
-
-bool Level2::ShouldQuit() const {
-    // Condition 1: First warrior exits screen
-    if (!m_warriors.empty() && m_warriors[0]->GetX() > 1920.0f) {
-        return true;
+        rock->Render(packet);
     }
-
-    // Condition 2: All warriors dead
-    bool allDead = true;
-    for (Warrior* w : m_warriors) {
-        if (w->IsAlive() || w->IsDying()) {
-            allDead = false;
-            break;
-        }
-    }
-    return allDead;
-}
-
-bool Level2::CheckAABBCollision(Warrior* w, Rock* r) {
-    float w_left = w->GetX();
-    float w_right = w->GetX() + w->GetWidth();
-    float w_top = w->GetY();
-    float w_bottom = w->GetY() + w->GetHeight();
-
-    float r_left = r->GetX();
-    float r_right = r->GetX() + r->GetWidth();
-    float r_top = r->GetY();
-    float r_bottom = r->GetY() + r->GetHeight();
-
-    return (w_left < r_right && w_right > r_left &&
-            w_top < r_bottom && w_bottom > r_top);
 }
 
-void Level2::CheckCollisions() {
+void Level2::CheckCollisions(float deltaTime) {
+    // Swept tests catch pairs that pass through each other within one step
+    float time;
+    uint64_t tests = 0;
     for (Rock* rock : m_rocks) {
         if (!rock->IsActive()) continue;
 
         for (Warrior* warrior : m_warriors) {
-            if (warrior->IsAlive() && CheckAABBCollision(warrior, rock)) {
-                warrior->StartDeathAnimation();
-                rock->SetActive(false);
-                break;  // Rock can only hit one warrior
+            if (!warrior->IsAlive()) continue;
+
+            ++tests;
+            if (SweepAABB(warrior, rock, deltaTime, time)) {
+                m_contacts.push_back({time, warrior, rock});
             }
         }
     }
+
+    Metrics::Add(Metric::COLLISION_TESTS, tests);
+    Metrics::Add(Metric::COLLISION_HITS, m_contacts.size());
+    ResolveContacts(m_contacts);
 }
 
-void Level2::CheckAutoSave() {
-    if (m_gameTime >= 5.0f && !m_autoSaved) {
-        SaveToFile("Level2.bin");
-        
-        // Reload to verify serialization
-        std::ifstream file("Level2.bin", std::ios::binary);
-        if (file.is_open()) {
-            // Don't actually reload in Level2, just mark as saved
-            file.close();
-            m_autoSaved = true;
-        }
+void Level2::AutoSave() {
+    if (m_autoSaved) {
+        return;
+    }
+
+    SaveToFile("Level2.bin");
+
+    // Reload to verify serialization
+    std::ifstream file("Level2.bin", std::ios::binary);
+    if (file.is_open()) {
+        // Don't actually reload in Level2, just mark as saved
+        file.close();
+        m_autoSaved = true;
     }
 }
 
@@ -149,9 +161,9 @@ void Level2::Deserialize(std::istream& stream) {
     size_t rockCount;
     stream.read(reinterpret_cast<char*>(&rockCount), sizeof(size_t));
 
-    m_rocks.clear();
+    ReleaseAll(m_rocks, m_world->GetRockPool());
     for (size_t i = 0; i < rockCount; ++i) {
-        Rock* rock = Rock::Pool->GetResource();
+        Rock* rock = m_world->GetRockPool()->GetResource();
         rock->Deserialize(stream);
         m_rocks.push_back(rock);
     }
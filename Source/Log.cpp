@@ -0,0 +1,337 @@
+#include "../Include/Log.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <thread>
+
+// Messages per thread; a power of two so positions wrap with a mask
+static const uint32_t RING_SIZE = 1024;
+
+// Longer messages are cut short and end in "..."
+static const size_t MESSAGE_SIZE = 240;
+
+// Threads that can hold a ring at once; rings of finished threads are reused
+static const int MAX_RINGS = 256;
+
+// How often the sink thread wakes to write out what's been logged
+static const std::chrono::milliseconds SINK_INTERVAL(10);
+
+struct LogRecord {
+    int64_t Time;    // Nanoseconds since Start()
+    LogLevel Level;
+    uint32_t Length;
+    char Text[MESSAGE_SIZE];
+};
+
+// Single producer (the owning thread), single consumer (whoever holds
+// s_drainMutex). Head and Tail only ever increase; the padding keeps the
+// two sides off each other's cache line.
+struct LogRing {
+    std::atomic<uint32_t> Head;
+    char HeadPadding[64];
+    std::atomic<uint32_t> Tail;
+    char TailPadding[64];
+    std::atomic<uint32_t> Dropped;
+    std::atomic<bool> InUse;
+    LogRecord Records[RING_SIZE];
+};
+
+// Hands the ring back for reuse when its thread exits
+struct RingHandle {
+    LogRing* Ring = nullptr;
+    ~RingHandle() {
+        if (Ring) {
+            Ring->InUse.store(false, std::memory_order_release);
+        }
+    }
+};
+
+// Rings come from calloc rather than new so they aren't charged to whatever
+// MemoryTag the thread happens to be in when it first logs. They live until
+// the process exits.
+static LogRing* s_rings[MAX_RINGS];
+static std::atomic<int> s_ringCount(0);
+static std::mutex s_ringsMutex;
+static thread_local RingHandle t_ring;
+
+static std::atomic<bool> s_running(false);
+static std::atomic<int> s_level((int)LogLevel::DEBUG);
+static std::chrono::steady_clock::time_point s_startTime;
+static FILE* s_file = nullptr;
+
+static std::thread s_sink;
+static std::mutex s_wakeMutex;
+static std::condition_variable s_wake;
+static bool s_stopping = false;
+static std::mutex s_drainMutex;
+
+static const char* GetLevelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO:  return "INFO";
+        case LogLevel::WARN:  return "WARN";
+        case LogLevel::ERR:   return "ERROR";
+    }
+    return "?";
+}
+
+static FILE* GetConsoleStream(LogLevel level) {
+    return level >= LogLevel::WARN ? stderr : stdout;
+}
+
+static void WriteLine(int64_t time, LogLevel level, const char* text, size_t length) {
+    if (s_file) {
+        fprintf(s_file, "[%10.3f] %-5s %.*s\n", time / 1e9, GetLevelName(level), (int)length, text);
+        return;
+    }
+
+    FILE* stream = GetConsoleStream(level);
+    fwrite(text, 1, length, stream);
+    fputc('\n', stream);
+}
+
+// Formats into text and returns the length written, marking truncation
+static size_t Format(char* text, size_t size, const char* format, va_list args) {
+    int length = vsnprintf(text, size, format, args);
+    if (length < 0) {
+        return 0;
+    }
+
+    if ((size_t)length >= size) {
+        memcpy(text + size - 4, "...", 4);
+        return size - 1;
+    }
+    return (size_t)length;
+}
+
+static LogRing* AcquireRing() {
+    std::lock_guard<std::mutex> lock(s_ringsMutex);
+
+    int count = s_ringCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i) {
+        if (!s_rings[i]->InUse.load(std::memory_order_acquire)) {
+            s_rings[i]->InUse.store(true, std::memory_order_relaxed);
+            return s_rings[i];
+        }
+    }
+
+    if (count == MAX_RINGS) {
+        return nullptr;
+    }
+
+    void* memory = std::calloc(1, sizeof(LogRing));
+    if (!memory) {
+        return nullptr;
+    }
+
+    LogRing* ring = new (memory) LogRing();
+    ring->InUse.store(true, std::memory_order_relaxed);
+    s_rings[count] = ring;
+    s_ringCount.store(count + 1, std::memory_order_release);
+    return ring;
+}
+
+// Writes out every record published so far, oldest first across threads
+static void Drain() {
+    std::lock_guard<std::mutex> lock(s_drainMutex);
+
+    int count = s_ringCount.load(std::memory_order_acquire);
+    uint32_t heads[MAX_RINGS];
+    uint32_t tails[MAX_RINGS];
+    uint32_t dropped = 0;
+    for (int i = 0; i < count; ++i) {
+        heads[i] = s_rings[i]->Head.load(std::memory_order_acquire);
+        tails[i] = s_rings[i]->Tail.load(std::memory_order_relaxed);
+        dropped += s_rings[i]->Dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    bool wrote = false;
+    while (true) {
+        int next = -1;
+        int64_t nextTime = 0;
+        for (int i = 0; i < count; ++i) {
+            if (tails[i] == heads[i]) {
+                continue;
+            }
+
+            int64_t time = s_rings[i]->Records[tails[i] & (RING_SIZE - 1)].Time;
+            if (next < 0 || time < nextTime) {
+                next = i;
+                nextTime = time;
+            }
+        }
+
+        if (next < 0) {
+            break;
+        }
+
+        const LogRecord& record = s_rings[next]->Records[tails[next] & (RING_SIZE - 1)];
+        WriteLine(record.Time, record.Level, record.Text, record.Length);
+        ++tails[next];
+        wrote = true;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        s_rings[i]->Tail.store(tails[i], std::memory_order_release);
+    }
+
+    if (dropped > 0) {
+        char text[64];
+        int length = snprintf(text, sizeof(text), "%u log messages dropped (ring buffer full)", dropped);
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - s_startTime).count();
+        WriteLine(now, LogLevel::WARN, text, (size_t)length);
+        wrote = true;
+    }
+
+    if (wrote) {
+        if (s_file) {
+            fflush(s_file);
+        } else {
+            fflush(stdout);
+            fflush(stderr);
+        }
+    }
+}
+
+static void SinkLoop() {
+    while (true) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(s_wakeMutex);
+            s_wake.wait_for(lock, SINK_INTERVAL, [] { return s_stopping; });
+            stopping = s_stopping;
+        }
+
+        Drain();
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+bool Log::Start(const std::string& filepath) {
+    if (s_running.load()) {
+        return true;
+    }
+
+    if (!filepath.empty()) {
+        s_file = fopen(filepath.c_str(), "w");
+        if (!s_file) {
+            std::cerr << "Failed to create log file: " << filepath << std::endl;
+            return false;
+        }
+    }
+
+    s_startTime = std::chrono::steady_clock::now();
+    s_stopping = false;
+    s_running.store(true, std::memory_order_release);
+    s_sink = std::thread(SinkLoop);
+    return true;
+}
+
+void Log::Stop() {
+    if (!s_running.load()) {
+        return;
+    }
+
+    // From here on messages are written synchronously
+    s_running.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(s_wakeMutex);
+        s_stopping = true;
+    }
+    s_wake.notify_one();
+    s_sink.join();
+
+    // Anything published while the sink was finishing
+    Drain();
+
+    if (s_file) {
+        fclose(s_file);
+        s_file = nullptr;
+    }
+}
+
+void Log::Flush() {
+    if (s_running.load(std::memory_order_acquire)) {
+        Drain();
+    }
+}
+
+void Log::SetLevel(LogLevel level) {
+    s_level.store((int)level, std::memory_order_relaxed);
+}
+
+LogLevel Log::GetLevel() {
+    return (LogLevel)s_level.load(std::memory_order_relaxed);
+}
+
+bool Log::ParseLevel(const std::string& name, LogLevel& level) {
+    if (name == "debug") {
+        level = LogLevel::DEBUG;
+    } else if (name == "info") {
+        level = LogLevel::INFO;
+    } else if (name == "warn" || name == "warning") {
+        level = LogLevel::WARN;
+    } else if (name == "error") {
+        level = LogLevel::ERR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void Log::Write(LogLevel level, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    WriteV(level, format, args);
+    va_end(args);
+}
+
+void Log::WriteV(LogLevel level, const char* format, va_list args) {
+    if ((int)level < s_level.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    LogRing* ring = nullptr;
+    if (s_running.load(std::memory_order_acquire)) {
+        if (!t_ring.Ring) {
+            t_ring.Ring = AcquireRing();
+        }
+        ring = t_ring.Ring;
+    }
+
+    if (!ring) {
+        // No sink running (or no ring left): write it here and now
+        char text[MESSAGE_SIZE];
+        size_t length = Format(text, sizeof(text), format, args);
+        FILE* stream = GetConsoleStream(level);
+        fwrite(text, 1, length, stream);
+        fputc('\n', stream);
+        fflush(stream);
+        return;
+    }
+
+    uint32_t head = ring->Head.load(std::memory_order_relaxed);
+    if (head - ring->Tail.load(std::memory_order_acquire) >= RING_SIZE) {
+        ring->Dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    LogRecord& record = ring->Records[head & (RING_SIZE - 1)];
+    record.Time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - s_startTime).count();
+    record.Level = level;
+    record.Length = (uint32_t)Format(record.Text, MESSAGE_SIZE, format, args);
+
+    // Publishes the record to the sink
+    ring->Head.store(head + 1, std::memory_order_release);
+}
@@ -0,0 +1,235 @@
+#include "../Include/MemoryTracker.h"
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+
+namespace {
+
+const size_t TAG_COUNT = (size_t)MemoryTag::COUNT;
+
+// Constant-initialized, so they're usable by allocations made before main()
+std::atomic<size_t> s_current[TAG_COUNT];
+std::atomic<size_t> s_peak[TAG_COUNT];
+std::atomic<size_t> s_live[TAG_COUNT];
+std::atomic<size_t> s_frameAllocs[TAG_COUNT];
+std::atomic<size_t> s_frameBytes[TAG_COUNT];
+std::atomic<size_t> s_totalCurrent;
+std::atomic<size_t> s_totalPeak;
+size_t s_lastFrameAllocs[TAG_COUNT];
+size_t s_lastFrameBytes[TAG_COUNT];
+
+thread_local MemoryTag t_tag = MemoryTag::UNTAGGED;
+
+const char* TAG_NAMES[TAG_COUNT] = {
+    "Untagged", "Assets", "Textures", "Pools", "Levels", "Renderer", "Transient"
+};
+
+void UpdatePeak(std::atomic<size_t>& peak, size_t current) {
+    size_t previous = peak.load(std::memory_order_relaxed);
+    while (current > previous &&
+           !peak.compare_exchange_weak(previous, current, std::memory_order_relaxed)) {
+    }
+}
+
+// Prepended to each global new allocation so delete knows what to uncharge
+struct alignas(alignof(std::max_align_t)) AllocationHeader {
+    size_t Size;
+    MemoryTag Tag;
+};
+
+void* TrackedAlloc(size_t size) {
+    void* block = malloc(sizeof(AllocationHeader) + size);
+    if (!block) {
+        return nullptr;
+    }
+
+    AllocationHeader* header = static_cast<AllocationHeader*>(block);
+    header->Size = size;
+    header->Tag = t_tag;
+    MemoryTracker::RecordAlloc(header->Tag, size);
+    return header + 1;
+}
+
+void TrackedFree(void* memory) {
+    if (!memory) {
+        return;
+    }
+
+    AllocationHeader* header = static_cast<AllocationHeader*>(memory) - 1;
+    MemoryTracker::RecordFree(header->Tag, header->Size);
+    free(header);
+}
+
+} // namespace
+
+void MemoryTracker::RecordAlloc(MemoryTag tag, size_t bytes) {
+    size_t index = (size_t)tag;
+    size_t current = s_current[index].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t total = s_totalCurrent.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    s_live[index].fetch_add(1, std::memory_order_relaxed);
+    s_frameAllocs[index].fetch_add(1, std::memory_order_relaxed);
+    s_frameBytes[index].fetch_add(bytes, std::memory_order_relaxed);
+
+    UpdatePeak(s_peak[index], current);
+    UpdatePeak(s_totalPeak, total);
+}
+
+void MemoryTracker::RecordFree(MemoryTag tag, size_t bytes) {
+    size_t index = (size_t)tag;
+    s_current[index].fetch_sub(bytes, std::memory_order_relaxed);
+    s_totalCurrent.fetch_sub(bytes, std::memory_order_relaxed);
+    s_live[index].fetch_sub(1, std::memory_order_relaxed);
+}
+
+void MemoryTracker::RecordResize(MemoryTag tag, size_t oldBytes, size_t newBytes) {
+    if (oldBytes == 0 || newBytes == 0) {
+        if (oldBytes > 0) RecordFree(tag, oldBytes);
+        if (newBytes > 0) RecordAlloc(tag, newBytes);
+        return;
+    }
+
+    size_t index = (size_t)tag;
+    if (newBytes > oldBytes) {
+        size_t grow = newBytes - oldBytes;
+        size_t current = s_current[index].fetch_add(grow, std::memory_order_relaxed) + grow;
+        size_t total = s_totalCurrent.fetch_add(grow, std::memory_order_relaxed) + grow;
+        s_frameBytes[index].fetch_add(grow, std::memory_order_relaxed);
+        UpdatePeak(s_peak[index], current);
+        UpdatePeak(s_totalPeak, total);
+    } else {
+        s_current[index].fetch_sub(oldBytes - newBytes, std::memory_order_relaxed);
+        s_totalCurrent.fetch_sub(oldBytes - newBytes, std::memory_order_relaxed);
+    }
+}
+
+MemoryTag MemoryTracker::GetThreadTag() {
+    return t_tag;
+}
+
+void MemoryTracker::SetThreadTag(MemoryTag tag) {
+    t_tag = tag;
+}
+
+MemoryStats MemoryTracker::GetStats(MemoryTag tag) {
+    size_t index = (size_t)tag;
+    MemoryStats stats;
+    stats.CurrentBytes = s_current[index].load(std::memory_order_relaxed);
+    stats.PeakBytes = s_peak[index].load(std::memory_order_relaxed);
+    stats.LiveAllocations = s_live[index].load(std::memory_order_relaxed);
+    stats.FrameAllocations = s_lastFrameAllocs[index];
+    stats.FrameBytes = s_lastFrameBytes[index];
+    return stats;
+}
+
+size_t MemoryTracker::GetTotalBytes() {
+    return s_totalCurrent.load(std::memory_order_relaxed);
+}
+
+size_t MemoryTracker::GetTotalPeakBytes() {
+    return s_totalPeak.load(std::memory_order_relaxed);
+}
+
+const char* MemoryTracker::GetTagName(MemoryTag tag) {
+    return tag < MemoryTag::COUNT ? TAG_NAMES[(size_t)tag] : "Unknown";
+}
+
+void MemoryTracker::EndFrame() {
+    for (size_t i = 0; i < TAG_COUNT; ++i) {
+        s_lastFrameAllocs[i] = s_frameAllocs[i].exchange(0, std::memory_order_relaxed);
+        s_lastFrameBytes[i] = s_frameBytes[i].exchange(0, std::memory_order_relaxed);
+    }
+}
+
+void MemoryTracker::PrintStats(std::ostream& stream) {
+    const double MB = 1024.0 * 1024.0;
+
+    stream << std::left << std::setw(10) << "Memory" << std::right
+           << std::setw(12) << "Current MB" << std::setw(10) << "Peak MB"
+           << std::setw(10) << "Live" << std::setw(14) << "Frame allocs"
+           << std::setw(12) << "Frame KB" << std::endl;
+
+    MemoryStats total = {};
+    for (size_t i = 0; i < TAG_COUNT; ++i) {
+        MemoryStats stats = GetStats((MemoryTag)i);
+        total.CurrentBytes += stats.CurrentBytes;
+        total.LiveAllocations += stats.LiveAllocations;
+        total.FrameAllocations += stats.FrameAllocations;
+        total.FrameBytes += stats.FrameBytes;
+
+        stream << std::left << std::setw(10) << TAG_NAMES[i] << std::right << std::fixed
+               << std::setprecision(2) << std::setw(12) << stats.CurrentBytes / MB
+               << std::setw(10) << stats.PeakBytes / MB << std::setw(10) << stats.LiveAllocations
+               << std::setw(14) << stats.FrameAllocations
+               << std::setprecision(1) << std::setw(12) << stats.FrameBytes / 1024.0 << std::endl;
+    }
+
+    stream << std::left << std::setw(10) << "Total" << std::right << std::fixed
+           << std::setprecision(2) << std::setw(12) << total.CurrentBytes / MB
+           << std::setw(10) << GetTotalPeakBytes() / MB << std::setw(10) << total.LiveAllocations
+           << std::setw(14) << total.FrameAllocations
+           << std::setprecision(1) << std::setw(12) << total.FrameBytes / 1024.0 << std::endl;
+}
+
+bool MemoryTracker::ReportLeaks(std::ostream& stream) {
+    bool clean = true;
+    for (size_t i = 0; i < TAG_COUNT; ++i) {
+        MemoryStats stats = GetStats((MemoryTag)i);
+        if ((MemoryTag)i == MemoryTag::UNTAGGED || stats.LiveAllocations == 0) {
+            continue;
+        }
+
+        stream << "Memory leak: " << stats.CurrentBytes << " bytes in " << stats.LiveAllocations
+               << " allocations still charged to " << TAG_NAMES[i] << std::endl;
+        clean = false;
+    }
+    return clean;
+}
+
+// Global allocation functions. The aligned overloads aren't replaced; they
+// pair with their own deletes and aren't used by the engine.
+
+void* operator new(size_t size) {
+    void* memory = TrackedAlloc(size);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return TrackedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return TrackedAlloc(size);
+}
+
+void operator delete(void* memory) noexcept {
+    TrackedFree(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    TrackedFree(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    TrackedFree(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    TrackedFree(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    TrackedFree(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    TrackedFree(memory);
+}
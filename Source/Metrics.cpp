@@ -0,0 +1,233 @@
+#include "../Include/Metrics.h"
+#include "../Include/Log.h"
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static const char* const SOCKET_PREFIX = "unix:";
+
+// Room for every metric's name and a 20-digit value
+static const size_t SNAPSHOT_SIZE = 2048;
+
+std::atomic<uint64_t> Metrics::s_values[(size_t)Metric::COUNT] = {};
+
+static const char* const METRIC_NAMES[] = {
+    "frames",
+    "draw_calls",
+    "collision_tests",
+    "collision_hits",
+    "save_bytes",
+    "warriors",
+    "warriors_alive",
+    "rocks",
+    "warrior_pool_total",
+    "warrior_pool_available",
+    "rock_pool_total",
+    "rock_pool_available",
+    "asset_stack_used",
+    "textures",
+    "texture_cpu_bytes",
+    "texture_gpu_bytes"
+};
+
+static_assert(sizeof(METRIC_NAMES) / sizeof(METRIC_NAMES[0]) == (size_t)Metric::COUNT,
+              "Every metric needs a name");
+
+const char* Metrics::GetName(Metric metric) {
+    return METRIC_NAMES[(size_t)metric];
+}
+
+MetricsExporter::MetricsExporter()
+    : m_stopping(false), m_csv(false), m_file(nullptr), m_socket(-1), m_interval(1000) {
+}
+
+MetricsExporter::~MetricsExporter() {
+    Stop();
+}
+
+bool MetricsExporter::Start(const std::string& target, int intervalMs) {
+    Stop();
+
+    if (target.rfind(SOCKET_PREFIX, 0) == 0) {
+#ifdef _WIN32
+        LOG_ERROR("Metrics sockets are only supported on Linux and macOS");
+        return false;
+#else
+        m_socketPath = target.substr(strlen(SOCKET_PREFIX));
+        sockaddr_un address;
+        if (m_socketPath.empty() || m_socketPath.size() >= sizeof(address.sun_path)) {
+            LOG_ERROR("Invalid metrics socket path: %s", m_socketPath.c_str());
+            return false;
+        }
+
+        // A listener that isn't up yet is retried at each snapshot
+        if (!Connect()) {
+            LOG_WARN("Metrics socket %s isn't listening yet", m_socketPath.c_str());
+        }
+#endif
+    } else {
+        m_file = fopen(target.c_str(), "w");
+        if (!m_file) {
+            LOG_ERROR("Failed to create metrics file: %s", target.c_str());
+            return false;
+        }
+
+        m_csv = target.size() >= 4 && target.compare(target.size() - 4, 4, ".csv") == 0;
+        if (m_csv) {
+            fputs("time", m_file);
+            for (size_t i = 0; i < (size_t)Metric::COUNT; ++i) {
+                fprintf(m_file, ",%s", METRIC_NAMES[i]);
+            }
+            fputc('\n', m_file);
+        }
+    }
+
+    m_interval = std::chrono::milliseconds(intervalMs > 0 ? intervalMs : 1000);
+    m_startTime = std::chrono::steady_clock::now();
+    m_stopping = false;
+    m_thread = std::thread(&MetricsExporter::ExportLoop, this);
+    return true;
+}
+
+void MetricsExporter::Stop() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+
+    // Final totals
+    Export();
+
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+    Disconnect();
+    m_socketPath.clear();
+}
+
+void MetricsExporter::ExportLoop() {
+    std::chrono::steady_clock::time_point next = m_startTime + m_interval;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_wake.wait_until(lock, next, [this] { return m_stopping; })) {
+        lock.unlock();
+        Export();
+        lock.lock();
+
+        // Keeps to the interval's grid; a slow export skips snapshots
+        // rather than bunching them up
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        while (next <= now) {
+            next += m_interval;
+        }
+    }
+}
+
+size_t MetricsExporter::FormatSnapshot(char* text, size_t size) const {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+
+    size_t length = 0;
+    auto append = [&](const char* format, auto... args) {
+        if (length < size) {
+            int written = snprintf(text + length, size - length, format, args...);
+            length += written > 0 ? (size_t)written : 0;
+        }
+    };
+
+    if (m_csv) {
+        append("%.3f", seconds);
+        for (size_t i = 0; i < (size_t)Metric::COUNT; ++i) {
+            append(",%llu", (unsigned long long)Metrics::Get((Metric)i));
+        }
+    } else {
+        append("{\"time\": %.3f", seconds);
+        for (size_t i = 0; i < (size_t)Metric::COUNT; ++i) {
+            append(", \"%s\": %llu", METRIC_NAMES[i], (unsigned long long)Metrics::Get((Metric)i));
+        }
+        append("}");
+    }
+    append("\n");
+
+    return std::min(length, size - 1);
+}
+
+void MetricsExporter::Export() {
+    // Formatted on the stack so exporting doesn't show up as heap traffic
+    char text[SNAPSHOT_SIZE];
+    size_t length = FormatSnapshot(text, sizeof(text));
+
+    if (m_file) {
+        fwrite(text, 1, length, m_file);
+        fflush(m_file);
+        return;
+    }
+
+#ifndef _WIN32
+    if (m_socket < 0 && !Connect()) {
+        return;
+    }
+
+    // Never waits on the reader: a partly sent line would corrupt the
+    // stream, so a reader that can't keep up is disconnected instead
+    ssize_t sent = send(m_socket, text, length, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent != (ssize_t)length) {
+        LOG_WARN("Metrics socket %s disconnected", m_socketPath.c_str());
+        Disconnect();
+    }
+#endif
+}
+
+bool MetricsExporter::Connect() {
+#ifdef _WIN32
+    return false;
+#else
+    if (m_socketPath.empty()) {
+        return false;
+    }
+
+    m_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_socket < 0) {
+        return false;
+    }
+
+#ifdef SO_NOSIGPIPE
+    // macOS has no MSG_NOSIGNAL
+    int noSigPipe = 1;
+    setsockopt(m_socket, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, m_socketPath.c_str(), sizeof(address.sun_path) - 1);
+    if (connect(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        Disconnect();
+        return false;
+    }
+    return true;
+#endif
+}
+
+void MetricsExporter::Disconnect() {
+#ifndef _WIN32
+    if (m_socket >= 0) {
+        close(m_socket);
+        m_socket = -1;
+    }
+#endif
+}
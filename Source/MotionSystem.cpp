@@ -0,0 +1,189 @@
+#include "../Include/MotionSystem.h"
+#include "../Include/CpuFeatures.h"
+
+#ifdef SIMD_DISPATCH
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MOTION_SSE2 1
+#endif
+
+namespace {
+    struct MotionArrays {
+        float* LocalX;
+        float* LocalY;
+        const float* LocalScale;
+        float* WorldX;
+        float* WorldY;
+        float* WorldScale;
+        const float* VelocityX;
+        const float* VelocityY;
+        const uint32_t* Moving;
+        const uint32_t* Driven;
+    };
+
+    void MoveScalar(const MotionArrays& a, size_t begin, size_t count, float deltaTime, const Transform& parent) {
+        for (size_t i = begin; i < count; ++i) {
+            if (a.Moving[i]) {
+                a.LocalX[i] += a.VelocityX[i] * deltaTime;
+                a.LocalY[i] += a.VelocityY[i] * deltaTime;
+            }
+            if (a.Driven[i]) {
+                a.WorldX[i] = parent.X + a.LocalX[i] * parent.Scale;
+                a.WorldY[i] = parent.Y + a.LocalY[i] * parent.Scale;
+                a.WorldScale[i] = parent.Scale * a.LocalScale[i];
+            }
+        }
+    }
+
+#ifdef MOTION_SSE2
+    // Lanes outside a mask keep their old value rather than adding zero,
+    // so the result matches the branches exactly (-0 included)
+    inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    void MoveSSE2(const MotionArrays& a, size_t begin, size_t count, float deltaTime, const Transform& parent) {
+        const __m128 dt = _mm_set1_ps(deltaTime);
+        const __m128 parentX = _mm_set1_ps(parent.X);
+        const __m128 parentY = _mm_set1_ps(parent.Y);
+        const __m128 parentScale = _mm_set1_ps(parent.Scale);
+        size_t i = begin;
+        for (; i + 4 <= count; i += 4) {
+            __m128 moving = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a.Moving + i)));
+            __m128 driven = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a.Driven + i)));
+            __m128 x = _mm_loadu_ps(a.LocalX + i);
+            __m128 y = _mm_loadu_ps(a.LocalY + i);
+            x = Select(moving, _mm_add_ps(x, _mm_mul_ps(_mm_loadu_ps(a.VelocityX + i), dt)), x);
+            y = Select(moving, _mm_add_ps(y, _mm_mul_ps(_mm_loadu_ps(a.VelocityY + i), dt)), y);
+            _mm_storeu_ps(a.LocalX + i, x);
+            _mm_storeu_ps(a.LocalY + i, y);
+
+            __m128 worldX = _mm_add_ps(parentX, _mm_mul_ps(x, parentScale));
+            __m128 worldY = _mm_add_ps(parentY, _mm_mul_ps(y, parentScale));
+            __m128 worldScale = _mm_mul_ps(parentScale, _mm_loadu_ps(a.LocalScale + i));
+            _mm_storeu_ps(a.WorldX + i, Select(driven, worldX, _mm_loadu_ps(a.WorldX + i)));
+            _mm_storeu_ps(a.WorldY + i, Select(driven, worldY, _mm_loadu_ps(a.WorldY + i)));
+            _mm_storeu_ps(a.WorldScale + i, Select(driven, worldScale, _mm_loadu_ps(a.WorldScale + i)));
+        }
+        MoveScalar(a, i, count, deltaTime, parent);
+    }
+#endif
+
+#ifdef SIMD_DISPATCH
+    // Bitwise, like Select: GCC rewrites blendv on a loaded integer mask
+    // into per-lane branches when only AVX (not AVX2) is enabled
+    SIMD_TARGET("avx") inline __m256 Select256(__m256 mask, __m256 a, __m256 b) {
+        return _mm256_or_ps(_mm256_and_ps(mask, a), _mm256_andnot_ps(mask, b));
+    }
+
+    SIMD_TARGET("avx") void MoveAVX(const MotionArrays& a, size_t begin, size_t count, float deltaTime, const Transform& parent) {
+        const __m256 dt = _mm256_set1_ps(deltaTime);
+        const __m256 parentX = _mm256_set1_ps(parent.X);
+        const __m256 parentY = _mm256_set1_ps(parent.Y);
+        const __m256 parentScale = _mm256_set1_ps(parent.Scale);
+        size_t i = begin;
+        for (; i + 8 <= count; i += 8) {
+            __m256 moving = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a.Moving + i)));
+            __m256 driven = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a.Driven + i)));
+            __m256 x = _mm256_loadu_ps(a.LocalX + i);
+            __m256 y = _mm256_loadu_ps(a.LocalY + i);
+            x = Select256(moving, _mm256_add_ps(x, _mm256_mul_ps(_mm256_loadu_ps(a.VelocityX + i), dt)), x);
+            y = Select256(moving, _mm256_add_ps(y, _mm256_mul_ps(_mm256_loadu_ps(a.VelocityY + i), dt)), y);
+            _mm256_storeu_ps(a.LocalX + i, x);
+            _mm256_storeu_ps(a.LocalY + i, y);
+
+            __m256 worldX = _mm256_add_ps(parentX, _mm256_mul_ps(x, parentScale));
+            __m256 worldY = _mm256_add_ps(parentY, _mm256_mul_ps(y, parentScale));
+            __m256 worldScale = _mm256_mul_ps(parentScale, _mm256_loadu_ps(a.LocalScale + i));
+            _mm256_storeu_ps(a.WorldX + i, Select256(driven, worldX, _mm256_loadu_ps(a.WorldX + i)));
+            _mm256_storeu_ps(a.WorldY + i, Select256(driven, worldY, _mm256_loadu_ps(a.WorldY + i)));
+            _mm256_storeu_ps(a.WorldScale + i, Select256(driven, worldScale, _mm256_loadu_ps(a.WorldScale + i)));
+        }
+
+        // Leave AVX state clean for the SSE2 tail, which may be a jump
+        _mm256_zeroupper();
+        MoveSSE2(a, i, count, deltaTime, parent);
+    }
+#endif
+
+    void Move(const MotionArrays& a, size_t count, float deltaTime, const Transform& parent, SimdLevel level) {
+#ifdef SIMD_DISPATCH
+        if (level >= SimdLevel::AVX) {
+            MoveAVX(a, 0, count, deltaTime, parent);
+            return;
+        }
+#endif
+#ifdef MOTION_SSE2
+        if (level >= SimdLevel::SSE2) {
+            MoveSSE2(a, 0, count, deltaTime, parent);
+            return;
+        }
+#endif
+        MoveScalar(a, 0, count, deltaTime, parent);
+    }
+}
+
+void MotionSystem::Reserve(size_t count) {
+    m_velocityX.reserve(count);
+    m_velocityY.reserve(count);
+    m_moving.reserve(count);
+    m_driven.reserve(count);
+}
+
+int MotionSystem::CreateInstance(int node) {
+    assert(m_transforms->GetParent(node) == m_parent);
+
+    if ((size_t)node >= m_velocityX.size()) {
+        m_velocityX.resize(node + 1, 0.0f);
+        m_velocityY.resize(node + 1, 0.0f);
+        m_moving.resize(node + 1, 0);
+        m_driven.resize(node + 1, 0);
+    }
+
+    SetVelocity(node, 0.0f, 0.0f);
+    SetMoving(node, false);
+    m_driven[node] = ~0u;
+    return node;
+}
+
+void MotionSystem::ReleaseInstance(int instance) {
+    SetMoving(instance, false);
+    m_driven[instance] = 0;
+}
+
+void MotionSystem::Update(float deltaTime) {
+    TransformSystem& t = *m_transforms;
+    MotionArrays arrays = {t.m_localX.data(), t.m_localY.data(), t.m_localScale.data(),
+                           t.m_worldX.data(), t.m_worldY.data(), t.m_worldScale.data(),
+                           m_velocityX.data(), m_velocityY.data(), m_moving.data(), m_driven.data()};
+
+    // If the parent itself is queued this places the instances under its
+    // old transform; the transform system's update then redoes them
+    Transform parent = {t.m_worldX[m_parent], t.m_worldY[m_parent], t.m_worldScale[m_parent]};
+
+    Move(arrays, m_velocityX.size(), deltaTime, parent, CpuFeatures::GetSimdLevel());
+    MarkMovedChildren();
+}
+
+void MotionSystem::UpdateReference(float deltaTime) {
+    TransformSystem& t = *m_transforms;
+    MotionArrays arrays = {t.m_localX.data(), t.m_localY.data(), t.m_localScale.data(),
+                           t.m_worldX.data(), t.m_worldY.data(), t.m_worldScale.data(),
+                           m_velocityX.data(), m_velocityY.data(), m_moving.data(), m_driven.data()};
+    Transform parent = {t.m_worldX[m_parent], t.m_worldY[m_parent], t.m_worldScale[m_parent]};
+
+    MoveScalar(arrays, 0, m_velocityX.size(), deltaTime, parent);
+    MarkMovedChildren();
+}
+
+void MotionSystem::MarkMovedChildren() {
+    // Usually just the parent itself: only entities carrying attachments
+    // have children
+    for (int node : m_transforms->GetParentNodes()) {
+        if ((size_t)node < m_moving.size() && m_moving[node] && m_driven[node]) {
+            m_transforms->MarkChildrenDirty(node);
+        }
+    }
+}
@@ -0,0 +1,156 @@
+#include "../Include/PerfRecorder.h"
+#include "../Include/FileController.h"
+#include "../Include/MemoryTracker.h"
+#include "../Include/Log.h"
+#include <iomanip>
+#include <sstream>
+
+PerfRecorder::PerfRecorder() : m_frameStart(0) {
+}
+
+void PerfRecorder::BeginFrame() {
+    m_frameStart = SDL_GetPerformanceCounter();
+}
+
+void PerfRecorder::EndFrame() {
+    Uint64 elapsed = SDL_GetPerformanceCounter() - m_frameStart;
+    m_frameMs.push_back((float)(elapsed * 1000.0 / (double)SDL_GetPerformanceFrequency()));
+
+    size_t allocations = 0;
+    for (size_t i = 0; i < (size_t)MemoryTag::COUNT; ++i) {
+        allocations += MemoryTracker::GetStats((MemoryTag)i).FrameAllocations;
+    }
+    m_frameAllocations.push_back(allocations);
+}
+
+void PerfRecorder::RecordLoad(const std::string& name, double milliseconds) {
+    // The recorder outlives the subsystems that call this; keep its
+    // bookkeeping out of their accounts
+    MemoryScope scope(MemoryTag::UNTAGGED);
+    m_loads.push_back({name, milliseconds});
+}
+
+void PerfRecorder::ComputeMetrics(std::vector<std::pair<std::string, double>>& metrics) const {
+    metrics.clear();
+
+    if (!m_frameMs.empty()) {
+        std::vector<float> sorted = m_frameMs;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&](double p) { return (double)sorted[(size_t)(p * (sorted.size() - 1))]; };
+
+        metrics.push_back({"frame_ms_p50", percentile(0.50)});
+        metrics.push_back({"frame_ms_p90", percentile(0.90)});
+        // No max: a single stall would make the gate flaky
+        metrics.push_back({"frame_ms_p99", percentile(0.99)});
+
+        size_t total = 0, most = 0;
+        for (size_t allocations : m_frameAllocations) {
+            total += allocations;
+            most = std::max(most, allocations);
+        }
+        metrics.push_back({"allocs_per_frame_mean", total / (double)m_frameAllocations.size()});
+        metrics.push_back({"allocs_per_frame_max", (double)most});
+    }
+
+    metrics.push_back({"peak_heap_mb", MemoryTracker::GetTotalPeakBytes() / (1024.0 * 1024.0)});
+
+    for (const auto& load : m_loads) {
+        metrics.push_back({"load_" + load.first + "_ms", load.second});
+    }
+}
+
+bool PerfRecorder::WriteReport(const std::string& filepath) const {
+    std::vector<std::pair<std::string, double>> metrics;
+    ComputeMetrics(metrics);
+
+    std::ostringstream json;
+    json << "{\n  \"frames\": " << m_frameMs.size() << ",\n  \"metrics\": {\n";
+    for (size_t i = 0; i < metrics.size(); ++i) {
+        json << "    \"" << metrics[i].first << "\": " << std::fixed << std::setprecision(3)
+             << metrics[i].second << (i + 1 < metrics.size() ? "," : "") << "\n";
+    }
+    json << "  }\n}\n";
+
+    std::string text = json.str();
+    return FileController::GetInstance()->WriteFile(filepath, text.data(), text.size());
+}
+
+bool PerfRecorder::ParseMetrics(const std::string& json, std::vector<std::pair<std::string, double>>& metrics) {
+    // Only the flat "metrics" object written by WriteReport() is understood
+    size_t start = json.find("\"metrics\"");
+    size_t open = json.find('{', start);
+    size_t close = json.find('}', open);
+    if (start == std::string::npos || open == std::string::npos || close == std::string::npos) {
+        return false;
+    }
+
+    std::string body = json.substr(open + 1, close - open - 1);
+    size_t position = 0;
+    while ((position = body.find('"', position)) != std::string::npos) {
+        size_t nameEnd = body.find('"', position + 1);
+        size_t colon = body.find(':', nameEnd);
+        if (nameEnd == std::string::npos || colon == std::string::npos) {
+            return false;
+        }
+
+        std::string name = body.substr(position + 1, nameEnd - position - 1);
+        char* end = nullptr;
+        double value = std::strtod(body.c_str() + colon + 1, &end);
+        if (end == body.c_str() + colon + 1) {
+            return false;
+        }
+
+        metrics.push_back({name, value});
+        position = end - body.c_str();
+    }
+    return true;
+}
+
+bool PerfRecorder::CheckBaseline(const std::string& filepath, double tolerance, bool checkTiming) const {
+    FileView data;
+    std::vector<std::pair<std::string, double>> baseline;
+    if (!FileController::GetInstance()->OpenFile(filepath, data) ||
+        !ParseMetrics(std::string(data.Data, data.Data + data.Size), baseline)) {
+        LOG_ERROR("Failed to read performance baseline: %s", filepath.c_str());
+        return false;
+    }
+
+    std::vector<std::pair<std::string, double>> current;
+    ComputeMetrics(current);
+
+    bool passed = true;
+    std::cout << std::left << std::setw(26) << "Metric" << std::right << std::setw(12) << "Baseline"
+              << std::setw(12) << "Current" << std::setw(12) << "Limit" << std::endl;
+
+    for (const auto& metric : baseline) {
+        auto found = std::find_if(current.begin(), current.end(),
+            [&](const std::pair<std::string, double>& m) { return m.first == metric.first; });
+        if (found == current.end()) {
+            std::cout << std::left << std::setw(26) << metric.first << "  missing from this run" << std::endl;
+            passed = false;
+            continue;
+        }
+
+        std::cout << std::left << std::setw(26) << metric.first << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(12) << metric.second << std::setw(12) << found->second;
+
+        // Times (frame_ms_*, load_*_ms) depend on the machine and build;
+        // they're shown but only compared when asked for
+        if (metric.first.find("_ms") != std::string::npos && !checkTiming) {
+            std::cout << std::setw(12) << "-" << std::endl;
+            continue;
+        }
+
+        // Small absolute slack so near-zero baselines don't fail on noise
+        double slack = metric.first.size() > 3 && metric.first.compare(metric.first.size() - 3, 3, "_ms") == 0
+                           ? 0.25 : 1.0;
+        double limit = metric.second * (1.0 + tolerance) + slack;
+        bool ok = found->second <= limit;
+        passed = passed && ok;
+        std::cout << std::setw(12) << limit << (ok ? "" : "  REGRESSED") << std::endl;
+    }
+
+    std::cout << (passed ? "Performance within " : "Performance regressed past ")
+              << (int)(tolerance * 100.0 + 0.5) << "% of " << filepath << std::endl;
+    return passed;
+}
@@ -0,0 +1,44 @@
+#include "../Include/RenderQueue.h"
+#include "../Include/Texture.h"
+
+static const SDL_Color WHITE = {255, 255, 255, 255};
+
+FramePacket::FramePacket()
+    : m_clearColor{0, 0, 0, 255} {
+}
+
+void FramePacket::Reset(SDL_Color clearColor) {
+    m_clearColor = clearColor;
+    m_commands.clear();
+}
+
+void FramePacket::RenderTexture(Texture* texture, float x, float y, float scale) {
+    if (!texture) return;
+
+    float width = (float)texture->GetWidth();
+    float height = (float)texture->GetHeight();
+    m_commands.push_back({texture, {0.0f, 0.0f, width, height}, {x, y, width * scale, height * scale}, WHITE});
+}
+
+void FramePacket::RenderAnimatedTexture(Texture* texture, const SDL_FRect& srcRect,
+                                        float x, float y, float scale) {
+    if (!texture) return;
+
+    m_commands.push_back({texture, srcRect, {x, y, srcRect.w * scale, srcRect.h * scale}, WHITE});
+}
+
+void FramePacket::RenderText(const std::string& text, int x, int y, SDL_Color color) {
+    // Placeholder until there's a font: a small rectangle for each character
+    int charWidth = 8;
+    int charHeight = 12;
+
+    for (size_t i = 0; i < text.length(); ++i) {
+        SDL_FRect dest = {
+            (float)(x + i * charWidth),
+            (float)y,
+            (float)charWidth - 1,
+            (float)charHeight
+        };
+        m_commands.push_back({nullptr, {0.0f, 0.0f, 0.0f, 0.0f}, dest, color});
+    }
+}
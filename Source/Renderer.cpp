@@ -1,6 +1,12 @@
 #include "../Include/Renderer.h"
+#include "../Include/ResidencyManager.h"
+#include "../Include/Log.h"
+#include "../Include/Metrics.h"
 
-Renderer::Renderer() : m_window(nullptr), m_renderer(nullptr) {
+Renderer::Renderer()
+    : m_window(nullptr), m_renderer(nullptr),
+      m_textureBytes(0), m_frameDraws(0), m_damageTracking(false), m_clearColor{0, 0, 0, 255},
+      m_softwareRaster(false), m_headless(false), m_rasterThreads(0), m_frameSurface(nullptr), m_capture(nullptr) {
 }
 
 Renderer::~Renderer() {
@@ -8,20 +14,57 @@ Renderer::~Renderer() {
 }
 
 bool Renderer::Initialize(const char* title, int width, int height) {
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        std::cerr << "SDL initialization failed: " << SDL_GetError() << std::endl;
+    // Headless runs still need events, but not a video driver
+    if (!SDL_Init(m_headless ? SDL_INIT_EVENTS : SDL_INIT_VIDEO)) {
+        LOG_ERROR("SDL initialization failed: %s", SDL_GetError());
         return false;
     }
 
+    if (m_softwareRaster) {
+        m_raster.Resize(width, height);
+        m_raster.SetThreadCount(m_rasterThreads);
+        m_damage.SetScreenSize(width, height);
+        if (m_headless) {
+            return true;
+        }
+    }
+
     m_window = SDL_CreateWindow(title, width, height, 0);
     if (!m_window) {
-        std::cerr << "Window creation failed: " << SDL_GetError() << std::endl;
+        LOG_ERROR("Window creation failed: %s", SDL_GetError());
         return false;
     }
 
-    m_renderer = SDL_CreateRenderer(m_window, nullptr);
+    if (m_softwareRaster) {
+        // The framebuffer is wrapped once and blitted to the window each frame
+        m_frameSurface = SDL_CreateSurfaceFrom(width, height, SDL_PIXELFORMAT_RGBA32,
+                                               m_raster.GetPixels(), m_raster.GetPitch());
+        if (!m_frameSurface) {
+            LOG_ERROR("Framebuffer surface creation failed: %s", SDL_GetError());
+            return false;
+        }
+
+        // Copy the framebuffer as-is; alpha was already resolved when drawing
+        SDL_SetSurfaceBlendMode(m_frameSurface, SDL_BLENDMODE_NONE);
+        return true;
+    }
+
+    if (m_damageTracking) {
+        // Draw straight into the window surface so untouched pixels persist
+        // between frames and only damaged rects need to be pushed out
+        SDL_Surface* surface = SDL_GetWindowSurface(m_window);
+        if (!surface) {
+            LOG_ERROR("Window surface creation failed: %s", SDL_GetError());
+            return false;
+        }
+        m_renderer = SDL_CreateSoftwareRenderer(surface);
+        m_damage.SetScreenSize(width, height);
+    } else {
+        m_renderer = SDL_CreateRenderer(m_window, nullptr);
+    }
+
     if (!m_renderer) {
-        std::cerr << "Renderer creation failed: " << SDL_GetError() << std::endl;
+        LOG_ERROR("Renderer creation failed: %s", SDL_GetError());
         return false;
     }
 
@@ -37,6 +80,17 @@ void Renderer::Shutdown() {
     }
     m_textureCache.clear();
 
+    for (auto& pair : m_rasterCache) {
+        delete pair.second;
+    }
+    m_rasterCache.clear();
+    m_textureBytes = 0;
+
+    if (m_frameSurface) {
+        SDL_DestroySurface(m_frameSurface);
+        m_frameSurface = nullptr;
+    }
+
     if (m_renderer) {
         SDL_DestroyRenderer(m_renderer);
         m_renderer = nullptr;
@@ -51,26 +105,167 @@ void Renderer::Shutdown() {
 }
 
 void Renderer::Clear() {
-    SDL_SetRenderDrawColor(m_renderer, 0, 0, 0, 255);
-    SDL_RenderClear(m_renderer);
+    ClearWithColor({0, 0, 0, 255});
 }
 
 void Renderer::ClearWithColor(SDL_Color color) {
+    if (m_damageTracking || m_softwareRaster) {
+        // Clearing is deferred to Present(); a new color dirties everything
+        if (color.r != m_clearColor.r || color.g != m_clearColor.g ||
+            color.b != m_clearColor.b || color.a != m_clearColor.a) {
+            m_damage.Invalidate();
+        }
+        m_clearColor = color;
+        return;
+    }
+
     SDL_SetRenderDrawColor(m_renderer, color.r, color.g, color.b, color.a);
     SDL_RenderClear(m_renderer);
 }
 
 void Renderer::Present() {
+    Metrics::Add(Metric::DRAW_CALLS, m_frameDraws);
+    m_frameDraws = 0;
+
+    if (m_softwareRaster || m_damageTracking) {
+        if (m_softwareRaster) {
+            PresentRaster();
+        } else {
+            PresentDamage();
+        }
+        CaptureFrame();
+        return;
+    }
+
+    // The backbuffer is undefined after present, so read it back first
+    CaptureFrame();
     SDL_RenderPresent(m_renderer);
 }
 
+void Renderer::CaptureFrame() {
+    if (!m_capture || !m_capture->CanSubmit()) {
+        return;
+    }
+
+    if (m_softwareRaster) {
+        m_capture->Submit(m_raster.GetPixels(), m_raster.GetPitch(),
+                          m_raster.GetWidth(), m_raster.GetHeight());
+        return;
+    }
+
+    // Damage tracking draws into the window surface, which keeps the whole
+    // frame; otherwise read the render target back (a GPU sync, but the
+    // encode and write still happen off this thread)
+    SDL_Surface* frame = m_damageTracking ? SDL_GetWindowSurface(m_window)
+                                          : SDL_RenderReadPixels(m_renderer, nullptr);
+    if (!frame) {
+        LOG_ERROR("Failed to read back frame: %s", SDL_GetError());
+        return;
+    }
+
+    SDL_Surface* rgba = frame;
+    if (frame->format != SDL_PIXELFORMAT_RGBA32) {
+        rgba = SDL_ConvertSurface(frame, SDL_PIXELFORMAT_RGBA32);
+    }
+    if (rgba) {
+        m_capture->Submit(rgba->pixels, rgba->pitch, rgba->w, rgba->h);
+    }
+
+    if (rgba && rgba != frame) {
+        SDL_DestroySurface(rgba);
+    }
+    if (!m_damageTracking) {
+        SDL_DestroySurface(frame);
+    }
+}
+
+void Renderer::PresentDamage() {
+    m_damage.Resolve();
+    const std::vector<SDL_Rect>& regions = m_damage.GetRegions();
+
+    for (const SDL_Rect& region : regions) {
+        SDL_FRect area = {(float)region.x, (float)region.y, (float)region.w, (float)region.h};
+
+        SDL_SetRenderClipRect(m_renderer, &region);
+        SDL_SetRenderDrawColor(m_renderer, m_clearColor.r, m_clearColor.g,
+                               m_clearColor.b, m_clearColor.a);
+        SDL_RenderFillRect(m_renderer, &area);
+
+        // Replay in submission order so overlaps resolve as in a full redraw
+        for (const DeferredDraw& draw : m_deferredDraws) {
+            if (SDL_HasRectIntersectionFloat(&draw.Dest, &area)) {
+                Draw(draw);
+            }
+        }
+    }
+
+    SDL_SetRenderClipRect(m_renderer, nullptr);
+    SDL_FlushRenderer(m_renderer);
+    SDL_UpdateWindowSurfaceRects(m_window, regions.data(), (int)regions.size());
+
+    m_deferredDraws.clear();
+}
+
+void Renderer::PresentRaster() {
+    // With damage tracking only the damaged regions are redrawn; otherwise
+    // the whole framebuffer is
+    std::vector<SDL_Rect> regions;
+    if (m_damageTracking) {
+        m_damage.Resolve();
+        regions = m_damage.GetRegions();
+    } else {
+        regions.push_back({0, 0, m_raster.GetWidth(), m_raster.GetHeight()});
+    }
+
+    m_rasterDraws.clear();
+    for (const DeferredDraw& draw : m_deferredDraws) {
+        m_rasterDraws.push_back({draw.Image, draw.Src, draw.Dest, draw.Color});
+    }
+    m_raster.DrawBatch(m_rasterDraws, regions, m_clearColor);
+
+    m_deferredDraws.clear();
+
+    if (m_window) {
+        SDL_Surface* surface = SDL_GetWindowSurface(m_window);
+        for (const SDL_Rect& region : regions) {
+            SDL_Rect target = region;
+            SDL_BlitSurface(m_frameSurface, &region, surface, &target);
+        }
+        SDL_UpdateWindowSurfaceRects(m_window, regions.data(), (int)regions.size());
+    }
+}
+
+void Renderer::Submit(const DeferredDraw& draw) {
+    ++m_frameDraws;
+    if (m_damageTracking) {
+        m_damage.AddRect(draw.Dest);
+    }
+
+    // The rasterizer draws the whole frame at Present()
+    if (m_damageTracking || m_softwareRaster) {
+        m_deferredDraws.push_back(draw);
+        return;
+    }
+
+    Draw(draw);
+}
+
+void Renderer::Draw(const DeferredDraw& draw) {
+    if (draw.Texture) {
+        SDL_RenderTexture(m_renderer, draw.Texture, &draw.Src, &draw.Dest);
+    } else {
+        SDL_SetRenderDrawColor(m_renderer, draw.Color.r, draw.Color.g, draw.Color.b, draw.Color.a);
+        SDL_RenderRect(m_renderer, &draw.Dest);
+    }
+}
+
 void Renderer::CreateSDLTexture(Texture* texture) {
-    if (!texture || !texture->GetImageInfo()) {
+    // Decodes the pixels if the texture isn't resident yet
+    ImageInfo* info = texture ? texture->Acquire() : nullptr;
+    if (!info) {
         return;
     }
 
-    ImageInfo* info = texture->GetImageInfo();
-    
     Uint32 format = (info->BitsPerPixel == 32) ? SDL_PIXELFORMAT_RGBA32 : SDL_PIXELFORMAT_RGB24;
     
     SDL_Texture* sdlTexture = SDL_CreateTexture(
@@ -82,84 +277,138 @@ void Renderer::CreateSDLTexture(Texture* texture) {
     );
 
     if (sdlTexture) {
-        SDL_SetTextureBlendMode(sdlTexture, SDL_BLENDMODE_BLEND);
+        // Cooked textures arrive premultiplied
+        SDL_SetTextureBlendMode(sdlTexture, info->Premultiplied ? SDL_BLENDMODE_BLEND_PREMULTIPLIED : SDL_BLENDMODE_BLEND);
         SDL_UpdateTexture(sdlTexture, nullptr, info->Data, 
                          info->Width * (info->BitsPerPixel / 8));
         m_textureCache[texture] = sdlTexture;
+        m_textureBytes += GetUploadedSize(sdlTexture);
+    }
+}
+
+size_t Renderer::GetUploadedSize(SDL_Texture* sdlTexture) {
+    // Renderers generally store texels as 32-bit, whatever the source format
+    return (size_t)sdlTexture->w * sdlTexture->h * 4;
+}
+
+const RasterImage* Renderer::GetRasterImage(Texture* texture) {
+    if (!texture) return nullptr;
+
+    texture->Touch(ResidencyManager::GetInstance()->GetFrame());
+
+    auto it = m_rasterCache.find(texture);
+    if (it != m_rasterCache.end()) {
+        return it->second;
+    }
+
+    ImageInfo* info = texture->Acquire();
+    if (!info) {
+        return nullptr;
+    }
+
+    RasterImage* image = new RasterImage();
+    image->Convert(info);
+    m_rasterCache[texture] = image;
+    m_textureBytes += image->GetByteSize();
+    return image;
+}
+
+bool Renderer::UploadTexture(Texture* texture) {
+    if (m_softwareRaster) {
+        return GetRasterImage(texture) != nullptr;
     }
+    return GetSDLTexture(texture) != nullptr;
+}
+
+bool Renderer::BindTexture(Texture* texture, DeferredDraw& draw) {
+    draw.Texture = nullptr;
+    draw.Image = nullptr;
+    if (m_softwareRaster) {
+        draw.Image = GetRasterImage(texture);
+    } else {
+        draw.Texture = GetSDLTexture(texture);
+    }
+    return draw.Texture || draw.Image;
 }
 
 SDL_Texture* Renderer::GetSDLTexture(Texture* texture) {
     if (!texture) return nullptr;
 
+    texture->Touch(ResidencyManager::GetInstance()->GetFrame());
+
     auto it = m_textureCache.find(texture);
     if (it != m_textureCache.end()) {
         return it->second;
     }
 
     CreateSDLTexture(texture);
-    return m_textureCache[texture];
+    it = m_textureCache.find(texture);
+    return (it != m_textureCache.end()) ? it->second : nullptr;
 }
 
-void Renderer::RenderTexture(Texture* texture, float x, float y, float scale) {
-    SDL_Texture* sdlTexture = GetSDLTexture(texture);
-    if (!sdlTexture) return;
-
-    ImageInfo* info = texture->GetImageInfo();
-    
-    SDL_FRect destRect = {
-        x,
-        y,
-        info->Width * scale,
-        info->Height * scale
-    };
+void Renderer::ReleaseUploadedTexture(Texture* texture) {
+    auto it = m_textureCache.find(texture);
+    if (it != m_textureCache.end()) {
+        m_textureBytes -= GetUploadedSize(it->second);
+        SDL_DestroyTexture(it->second);
+        m_textureCache.erase(it);
+    }
 
-    SDL_RenderTexture(m_renderer, sdlTexture, nullptr, &destRect);
+    auto image = m_rasterCache.find(texture);
+    if (image != m_rasterCache.end()) {
+        m_textureBytes -= image->second->GetByteSize();
+        delete image->second;
+        m_rasterCache.erase(image);
+    }
 }
 
-void Renderer::RenderAnimatedTexture(Texture* texture, int frame, int totalFrames,
-                                     float x, float y, float scale) {
-    SDL_Texture* sdlTexture = GetSDLTexture(texture);
-    if (!sdlTexture) return;
+void Renderer::RefreshTexture(Texture* texture) {
+    if (m_rasterCache.count(texture)) {
+        // Converted images are cheap to rebuild from the new pixels
+        ReleaseUploadedTexture(texture);
+        GetRasterImage(texture);
+        return;
+    }
 
-    ImageInfo* info = texture->GetImageInfo();
-    int frameWidth = info->Width / totalFrames;
+    auto it = m_textureCache.find(texture);
+    if (it == m_textureCache.end()) {
+        return; // Not uploaded yet; GetSDLTexture will pick up the new pixels
+    }
 
-    SDL_Rect srcRect = {
-        frame * frameWidth,
-        0,
-        frameWidth,
-        info->Height
-    };
+    ImageInfo* info = texture->Acquire();
+    SDL_Texture* sdlTexture = it->second;
+    Uint32 format = (info && info->BitsPerPixel == 32) ? SDL_PIXELFORMAT_RGBA32 : SDL_PIXELFORMAT_RGB24;
 
-    SDL_FRect destRect = {
-        x,
-        y,
-        frameWidth * scale,
-        info->Height * scale
-    };
+    if (info && sdlTexture->w == info->Width && sdlTexture->h == info->Height &&
+        sdlTexture->format == format) {
+        SDL_SetTextureBlendMode(sdlTexture, info->Premultiplied ? SDL_BLENDMODE_BLEND_PREMULTIPLIED : SDL_BLENDMODE_BLEND);
+        SDL_UpdateTexture(sdlTexture, nullptr, info->Data,
+                         info->Width * (info->BitsPerPixel / 8));
+        return;
+    }
 
-    SDL_RenderTexture(m_renderer, sdlTexture, &srcRect, &destRect);
+    // Size or format changed, so the texture has to be recreated
+    ReleaseUploadedTexture(texture);
+    CreateSDLTexture(texture);
 }
 
-void Renderer::RenderText(const std::string& text, int x, int y, SDL_Color color) {
-    // Simple debug text rendering using SDL's built-in capabilities
-    // For a full implementation, you would use SDL_ttf
-    // For now, we'll just render colored rectangles to indicate text position
-    
-    SDL_SetRenderDrawColor(m_renderer, color.r, color.g, color.b, color.a);
-    
-    // Simple placeholder - render a small rectangle for each character
-    int charWidth = 8;
-    int charHeight = 12;
-    
-    for (size_t i = 0; i < text.length(); ++i) {
-        SDL_FRect rect = {
-            (float)(x + i * charWidth),
-            (float)y,
-            (float)charWidth - 1,
-            (float)charHeight
-        };
-        SDL_RenderRect(m_renderer, &rect);
+void Renderer::RenderPacket(const FramePacket& packet) {
+    ClearWithColor(packet.GetClearColor());
+
+    for (const RenderCommand& command : packet.GetCommands()) {
+        DeferredDraw draw;
+        if (command.Handle) {
+            if (!BindTexture(command.Handle, draw)) continue;
+        } else {
+            draw.Texture = nullptr;
+            draw.Image = nullptr;
+        }
+
+        draw.Src = command.Src;
+        draw.Dest = command.Dest;
+        draw.Color = command.Color;
+        Submit(draw);
     }
+
+    Present();
 }
@@ -0,0 +1,122 @@
+#include "../Include/ResidencyManager.h"
+#include "../Include/Texture.h"
+#include "../Include/Renderer.h"
+
+ResidencyManager::ResidencyManager()
+    : m_frame(0), m_cpuBytes(0),
+      m_cpuBudget(64 * 1024 * 1024), m_textureBudget(64 * 1024 * 1024) {
+}
+
+ResidencyManager::~ResidencyManager() {
+    // Let in-flight decodes finish before their textures go away
+    for (auto& pair : m_prefetches) {
+        ImageInfo* info = pair.second.get();
+        if (info) {
+            if (!info->Mapped) {
+                delete[] info->Data;
+            }
+            delete info;
+        }
+    }
+    m_prefetches.clear();
+}
+
+void ResidencyManager::SetBudgets(size_t cpuBytes, size_t textureBytes) {
+    m_cpuBudget = cpuBytes;
+    m_textureBudget = textureBytes;
+}
+
+void ResidencyManager::Register(Texture* texture) {
+    if (std::find(m_textures.begin(), m_textures.end(), texture) == m_textures.end()) {
+        m_textures.push_back(texture);
+    }
+}
+
+void ResidencyManager::Unregister(Texture* texture) {
+    m_textures.erase(std::remove(m_textures.begin(), m_textures.end(), texture), m_textures.end());
+
+    auto it = m_prefetches.find(texture);
+    if (it != m_prefetches.end()) {
+        ImageInfo* info = it->second.get();
+        if (info) {
+            if (!info->Mapped) {
+                delete[] info->Data;
+            }
+            delete info;
+        }
+        m_prefetches.erase(it);
+    }
+}
+
+void ResidencyManager::BeginFrame() {
+    m_frame++;
+
+    for (auto it = m_prefetches.begin(); it != m_prefetches.end(); ) {
+        if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+
+        ImageInfo* info = it->second.get();
+        Texture* texture = it->first;
+        it = m_prefetches.erase(it);
+        if (info) {
+            texture->Reload(info);
+        }
+    }
+}
+
+void ResidencyManager::Prefetch(Texture* texture) {
+    if (!texture || texture->IsResident() || m_prefetches.count(texture)) {
+        return;
+    }
+
+    std::string filepath = texture->GetFilepath();
+    std::string cookedPath = texture->GetCookedPath();
+    m_prefetches[texture] = std::async(std::launch::async,
+        [filepath, cookedPath]() { return Texture::ReadPixels(filepath, cookedPath); });
+}
+
+ImageInfo* ResidencyManager::Decode(Texture* texture) {
+    auto it = m_prefetches.find(texture);
+    if (it != m_prefetches.end()) {
+        ImageInfo* info = it->second.get();
+        m_prefetches.erase(it);
+        return info;
+    }
+
+    return Texture::ReadPixels(texture->GetFilepath(), texture->GetCookedPath());
+}
+
+void ResidencyManager::GatherEvictionCandidates(std::vector<Texture*>& candidates,
+                                                bool uploaded, Renderer* renderer) {
+    candidates.clear();
+    for (Texture* texture : m_textures) {
+        bool present = uploaded ? renderer->HasUploadedTexture(texture) : texture->IsResident();
+        if (present && texture->GetLastUseFrame() < m_frame) {
+            candidates.push_back(texture);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](Texture* a, Texture* b) {
+        return a->GetLastUseFrame() < b->GetLastUseFrame();
+    });
+}
+
+void ResidencyManager::EnforceBudgets(Renderer* renderer) {
+    if (m_textureBudget > 0 && renderer->GetTextureBytes() > m_textureBudget) {
+        GatherEvictionCandidates(m_candidates, true, renderer);
+        for (Texture* texture : m_candidates) {
+            if (renderer->GetTextureBytes() <= m_textureBudget) break;
+            renderer->ReleaseUploadedTexture(texture);
+        }
+    }
+
+    if (m_cpuBudget > 0 && GetCpuBytes() > m_cpuBudget) {
+        GatherEvictionCandidates(m_candidates, false, renderer);
+        for (Texture* texture : m_candidates) {
+            if (GetCpuBytes() <= m_cpuBudget) break;
+            texture->Evict();
+        }
+    }
+}
@@ -1,85 +1,117 @@
 #include "../Include/Rock.h"
-#include "../Include/Renderer.h"
-
-ObjectPool<Rock>* Rock::Pool = nullptr;
+#include "../Include/RenderQueue.h"
+#include "../Include/World.h"
 
 Rock::Rock()
-    : m_x(0), m_y(0), m_speed(0), m_scale(1.0f),
-      m_animSpeed(0), m_animTimer(0), m_currentFrame(0),
-      m_active(true), m_texture(nullptr) {
+    : m_speed(0), m_scale(1.0f), m_animSpeed(0), m_active(true),
+      m_animationSystem(nullptr), m_motionSystem(nullptr), m_transformSystem(nullptr),
+      m_animation(-1), m_motion(-1), m_transform(-1) {
 }
 
 Rock::~Rock() {
-    // Texture is managed by pool
+    if (m_animation >= 0) {
+        m_animationSystem->ReleaseInstance(m_animation);
+        m_motionSystem->ReleaseInstance(m_motion);
+        m_transformSystem->ReleaseNode(m_transform);
+    }
+}
+
+void Rock::BindWorld() {
+    if (m_animation < 0) {
+        World* world = World::GetCurrent();
+        m_animationSystem = world->GetAnimation();
+        m_animation = m_animationSystem->CreateInstance(nullptr);
+        m_transformSystem = world->GetTransforms();
+        m_transform = m_transformSystem->CreateNode(world->GetRoot());
+        m_motionSystem = world->GetMotion();
+        m_motion = m_motionSystem->CreateInstance(m_transform);
+    }
 }
 
 void Rock::Initialize(float x, float y, float speed, float animSpeed, float scale) {
-    m_x = x;
-    m_y = y;
     m_speed = speed;
     m_animSpeed = animSpeed;
     m_scale = scale;
-    m_animTimer = 0.0f;
-    m_currentFrame = 0;
     m_active = true;
 
-    // Load texture
-    if (!m_texture) {
-        m_texture = Texture::Pool->GetResource();
-        m_texture->Load("Assets/Textures/rock.tga");
-    }
+    BindWorld();
+    m_transformSystem->SetLocalScale(m_transform, m_scale);
+    m_motionSystem->SetPosition(m_motion, x, y);
+    m_motionSystem->SetVelocity(m_motion, 0.0f, m_speed);
+    m_motionSystem->SetMoving(m_motion, true);
+
+    AnimationSystem* animation = m_animationSystem;
+    animation->Play(m_animation, animation->FindClip(CLIP), m_animSpeed);
 }
 
-void Rock::Update(float deltaTime) {
+void Rock::Render(FramePacket* packet) {
     if (!m_active) {
         return;
     }
 
-    // Move rock downward
-    m_y += m_speed * deltaTime;
-
-    // Update animation
-    m_animTimer += deltaTime * m_animSpeed;
+    AnimationSystem* animation = m_animationSystem;
+    Texture* texture = animation->GetTexture(m_animation);
 
-    if (m_animTimer >= 1.0f) {
-        m_animTimer -= 1.0f;
-        m_currentFrame = (m_currentFrame + 1) % FRAMES;
+    if (texture) {
+        Transform world = m_transformSystem->GetWorld(m_transform);
+        packet->RenderAnimatedTexture(texture, animation->GetSourceRect(m_animation),
+                                      world.X, world.Y, world.Scale);
     }
 }
 
-void Rock::Render(Renderer* renderer) {
-    if (!m_active || !m_texture) {
-        return;
-    }
+void Rock::SetActive(bool active) {
+    m_active = active;
 
-    renderer->RenderAnimatedTexture(m_texture, m_currentFrame, FRAMES,
-                                    m_x, m_y, m_scale);
+    if (m_motion >= 0) {
+        m_motionSystem->SetMoving(m_motion, m_active);
+    }
+    if (!m_active && m_animation >= 0) {
+        m_animationSystem->Stop(m_animation);
+    }
 }
 
 void Rock::Serialize(std::ostream& stream) {
-    stream.write(reinterpret_cast<const char*>(&m_x), sizeof(float));
-    stream.write(reinterpret_cast<const char*>(&m_y), sizeof(float));
+    AnimationSystem* animation = m_animationSystem;
+    float animTimer = animation->GetTimer(m_animation);
+    int currentFrame = animation->GetFrame(m_animation);
+    float x = m_motionSystem->GetX(m_motion);
+    float y = m_motionSystem->GetY(m_motion);
+
+    stream.write(reinterpret_cast<const char*>(&x), sizeof(float));
+    stream.write(reinterpret_cast<const char*>(&y), sizeof(float));
     stream.write(reinterpret_cast<const char*>(&m_speed), sizeof(float));
     stream.write(reinterpret_cast<const char*>(&m_scale), sizeof(float));
     stream.write(reinterpret_cast<const char*>(&m_animSpeed), sizeof(float));
-    stream.write(reinterpret_cast<const char*>(&m_animTimer), sizeof(float));
-    stream.write(reinterpret_cast<const char*>(&m_currentFrame), sizeof(int));
+    stream.write(reinterpret_cast<const char*>(&animTimer), sizeof(float));
+    stream.write(reinterpret_cast<const char*>(&currentFrame), sizeof(int));
     stream.write(reinterpret_cast<const char*>(&m_active), sizeof(bool));
 }
 
 void Rock::Deserialize(std::istream& stream) {
-    stream.read(reinterpret_cast<char*>(&m_x), sizeof(float));
-    stream.read(reinterpret_cast<char*>(&m_y), sizeof(float));
+    float x, y;
+    float animTimer;
+    int currentFrame;
+
+    stream.read(reinterpret_cast<char*>(&x), sizeof(float));
+    stream.read(reinterpret_cast<char*>(&y), sizeof(float));
     stream.read(reinterpret_cast<char*>(&m_speed), sizeof(float));
     stream.read(reinterpret_cast<char*>(&m_scale), sizeof(float));
     stream.read(reinterpret_cast<char*>(&m_animSpeed), sizeof(float));
-    stream.read(reinterpret_cast<char*>(&m_animTimer), sizeof(float));
-    stream.read(reinterpret_cast<char*>(&m_currentFrame), sizeof(int));
+    stream.read(reinterpret_cast<char*>(&animTimer), sizeof(float));
+    stream.read(reinterpret_cast<char*>(&currentFrame), sizeof(int));
     stream.read(reinterpret_cast<char*>(&m_active), sizeof(bool));
 
-    // Reload texture
-    if (!m_texture) {
-        m_texture = Texture::Pool->GetResource();
-        m_texture->Load("Assets/Textures/rock.tga");
+    // Restore position and animation playback
+    BindWorld();
+    m_transformSystem->SetLocalScale(m_transform, m_scale);
+    m_motionSystem->SetPosition(m_motion, x, y);
+    m_motionSystem->SetVelocity(m_motion, 0.0f, m_speed);
+    m_motionSystem->SetMoving(m_motion, m_active);
+
+    AnimationSystem* animation = m_animationSystem;
+    animation->Play(m_animation, animation->FindClip(CLIP), m_animSpeed);
+    animation->SetState(m_animation, currentFrame, animTimer);
+    if (!m_active) {
+        animation->Stop(m_animation);
     }
 }
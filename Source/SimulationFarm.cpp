@@ -0,0 +1,187 @@
+#include "../Include/SimulationFarm.h"
+#include "../Include/Level1.h"
+#include "../Include/World.h"
+#include "../Include/WorkerPool.h"
+#include "../Include/AnimationSystem.h"
+#include "../Include/AssetController.h"
+#include "../Include/FileController.h"
+#include "../Include/ResidencyManager.h"
+#include "../Include/MemoryTracker.h"
+#include "../Include/Log.h"
+#include <iomanip>
+#include <thread>
+
+SimulationFarm::SimulationFarm(const FarmConfig& config)
+    : m_config(config), m_baseSeed(0), m_threadCount(1), m_wallMs(0) {
+}
+
+bool SimulationFarm::Run() {
+    m_results.clear();
+    if (m_config.Worlds <= 0 || m_config.StepRate <= 0.0f) {
+        LOG_ERROR("Simulation farm needs at least one world and a positive step rate");
+        return false;
+    }
+
+    m_baseSeed = m_config.Seed;
+    if (m_baseSeed == 0) {
+        std::random_device rd;
+        m_baseSeed = std::max(1u, (unsigned int)rd());
+    }
+
+    // Clip definitions are the only assets a headless world needs; sheets
+    // are sized from their headers and never decoded
+    Texture::Pool = new ObjectPool<Texture>(10, "Texture");
+    if (!FileController::GetInstance()->MountArchive("Assets.pak")) {
+        AssetController::GetInstance()->RegisterPaths("Assets");
+    }
+    bool loaded;
+    {
+        MemoryScope scope(MemoryTag::ASSETS);
+        loaded = AnimationSystem::GetInstance()->LoadClips("Assets/Animations/clips.txt");
+    }
+
+    if (loaded) {
+        // The calling thread runs worlds too; 1 runs them all on it
+        m_threadCount = m_config.Threads != 0 ? m_config.Threads : std::max(1u, std::thread::hardware_concurrency());
+        std::unique_ptr<WorkerPool> workers;
+        if (m_threadCount > 1) {
+            workers.reset(new WorkerPool(m_threadCount - 1));
+        }
+
+        m_results.resize(m_config.Worlds);
+        Uint64 start = SDL_GetPerformanceCounter();
+        auto job = [this](size_t i) {
+            m_results[i] = RunWorld(m_baseSeed + (unsigned int)i * SEED_STRIDE);
+        };
+        if (workers) {
+            workers->ParallelFor(m_results.size(), job);
+        } else {
+            for (size_t i = 0; i < m_results.size(); ++i) {
+                job(i);
+            }
+        }
+        m_wallMs = (SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    } else {
+        LOG_ERROR("Failed to load animation clips!");
+    }
+
+    AnimationSystem::DestroyInstance();
+    delete Texture::Pool;
+    Texture::Pool = nullptr;
+    ResidencyManager::DestroyInstance();
+    AssetController::DestroyInstance();
+    FileController::DestroyInstance();
+    MemoryTracker::ReportLeaks(std::cerr);
+
+    return loaded;
+}
+
+WorldResult SimulationFarm::RunWorld(unsigned int seed) const {
+    WorldResult result;
+    result.Seed = seed;
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    MemoryScope scope(MemoryTag::LEVELS);
+    World world(20, 20, seed);
+    world.SetAutoSave(false);
+    World::Binding binding(&world);
+
+    const float step = 1.0f / m_config.StepRate;
+    Level* level = new Level1();
+    level->Initialize();
+    level->Start();
+    world.GetTransforms()->Update();
+    result.Warriors = (int)level->GetWarriors().size();
+
+    // Same order as GameController::Simulate: animation, level, transforms,
+    // transition
+    float time = 0.0f;
+    while (time < m_config.TimeLimit && !level->ShouldQuit()) {
+        world.GetAnimation()->Update(step);
+        level->Update(step);
+        world.GetTransforms()->Update();
+        time += step;
+
+        if (level->ShouldTransition()) {
+            Level* next = level->CreateNextLevel();
+            if (!next) {
+                break;
+            }
+            result.Level1Seconds = level->GetGameTime();
+
+            next->Preload();
+            next->Initialize();
+            next->TakeWarriors(level);
+            delete level;
+            level = next;
+            level->Start();
+            world.GetTransforms()->Update();
+        }
+    }
+
+    result.Finished = level->ShouldQuit();
+    if (level->GetLevelNumber() == 2) {
+        result.Level2Seconds = level->GetGameTime();
+        for (Warrior* warrior : level->GetWarriors()) {
+            if (warrior->IsAlive()) {
+                result.Survivors++;
+            }
+        }
+    }
+    delete level;
+
+    result.WallMs = (SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    return result;
+}
+
+void SimulationFarm::PrintSummary(std::ostream& out) const {
+    if (m_results.empty()) {
+        return;
+    }
+
+    int finished = 0, warriors = 0, survivors = 0;
+    int fewest = m_results[0].Survivors, most = m_results[0].Survivors;
+    double level1 = 0.0, level2 = 0.0;
+    std::vector<double> wallMs;
+    std::vector<int> histogram;
+
+    for (const WorldResult& result : m_results) {
+        finished += result.Finished ? 1 : 0;
+        warriors += result.Warriors;
+        survivors += result.Survivors;
+        fewest = std::min(fewest, result.Survivors);
+        most = std::max(most, result.Survivors);
+        level1 += result.Level1Seconds;
+        level2 += result.Level2Seconds;
+        wallMs.push_back(result.WallMs);
+
+        if ((int)histogram.size() <= result.Survivors) {
+            histogram.resize(result.Survivors + 1, 0);
+        }
+        histogram[result.Survivors]++;
+    }
+
+    const double count = (double)m_results.size();
+    std::sort(wallMs.begin(), wallMs.end());
+    auto percentile = [&](double p) { return wallMs[(size_t)(p * (wallMs.size() - 1))]; };
+
+    out << std::fixed << std::setprecision(2)
+        << "Simulation farm: " << m_results.size() << " worlds on " << m_threadCount << " threads in "
+        << m_wallMs << " ms (" << count * 1000.0 / std::max(m_wallMs, 0.001) << " worlds/s), base seed "
+        << m_baseSeed << std::endl
+        << "  Finished:  " << finished << " of " << m_results.size() << std::endl
+        << "  Survivors: mean " << survivors / count << " of " << warriors / count
+        << ", min " << fewest << ", max " << most
+        << " (" << (warriors > 0 ? 100.0 * survivors / warriors : 0.0) << "% survival)" << std::endl
+        << "  Level 1:   mean " << level1 / count << " s game time" << std::endl
+        << "  Level 2:   mean " << level2 / count << " s game time" << std::endl
+        << "  World ms:  p50 " << percentile(0.50) << ", p90 " << percentile(0.90)
+        << ", max " << wallMs.back() << std::endl
+        << "  Survivors per world:" << std::endl;
+
+    for (size_t i = 0; i < histogram.size(); ++i) {
+        if (histogram[i] > 0) {
+            out << "    " << std::setw(3) << i << ": " << histogram[i] << std::endl;
+        }
+    }
+}
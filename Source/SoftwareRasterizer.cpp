@@ -0,0 +1,391 @@
+#include "../Include/SoftwareRasterizer.h"
+#include "../Include/CpuFeatures.h"
+#include <cstring>
+
+#ifdef SIMD_DISPATCH
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RASTER_SSE2 1
+#endif
+
+namespace {
+    // Pixels blended per span chunk; small enough to stay on the stack
+    const int CHUNK = 256;
+
+    // x / 255 rounded, for x in [0, 255 * 255]; (t * 257) >> 16 with
+    // t = x + 128, which is what the SIMD kernels compute with mulhi
+    inline Uint32 Div255(Uint32 x) {
+        x += 128;
+        return (x * 257) >> 16;
+    }
+
+    // Premultiplied source-over: dst = src + dst * (255 - srcA) / 255
+    inline Uint32 BlendPixel(Uint32 src, Uint32 dst) {
+        Uint32 inv = 255 - (src >> 24);
+        Uint32 r = Div255((dst & 0xFF) * inv);
+        Uint32 g = Div255(((dst >> 8) & 0xFF) * inv);
+        Uint32 b = Div255(((dst >> 16) & 0xFF) * inv);
+        Uint32 a = Div255((dst >> 24) * inv);
+        return src + (r | (g << 8) | (b << 16) | (a << 24));
+    }
+
+    void BlendScalar(const Uint32* src, Uint32* dst, int count) {
+        for (int i = 0; i < count; ++i) {
+            Uint32 alpha = src[i] >> 24;
+            if (alpha == 255) {
+                dst[i] = src[i];
+            } else if (alpha != 0) {
+                dst[i] = BlendPixel(src[i], dst[i]);
+            }
+        }
+    }
+
+#ifdef RASTER_SSE2
+    // Blends two pixels widened to 16 bits per channel
+    inline __m128i Blend2(__m128i src16, __m128i dst16) {
+        __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src16, 0xFF), 0xFF);
+        __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+        __m128i t = _mm_add_epi16(_mm_mullo_epi16(dst16, inv), _mm_set1_epi16(128));
+        return _mm_mulhi_epu16(t, _mm_set1_epi16(257));
+    }
+
+    void BlendSSE2(const Uint32* src, Uint32* dst, int count) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i alpha = _mm_and_si128(s, alphaMask);
+
+            // Opaque runs are copied and transparent runs skipped outright
+            int opaque = _mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alphaMask));
+            if (opaque == 0xFFFF) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+                continue;
+            }
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) == 0xFFFF) {
+                continue;
+            }
+
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            __m128i lo = Blend2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+            __m128i hi = Blend2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+            __m128i result = _mm_add_epi8(s, _mm_packus_epi16(lo, hi));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), result);
+        }
+        BlendScalar(src + i, dst + i, count - i);
+    }
+#endif
+
+#ifdef SIMD_DISPATCH
+    SIMD_TARGET("avx2") inline __m256i Blend2x4(__m256i src16, __m256i dst16) {
+        __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(src16, 0xFF), 0xFF);
+        __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+        __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(dst16, inv), _mm256_set1_epi16(128));
+        return _mm256_mulhi_epu16(t, _mm256_set1_epi16(257));
+    }
+
+    SIMD_TARGET("avx2") void BlendAVX2(const Uint32* src, Uint32* dst, int count) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i alphaMask = _mm256_set1_epi32((int)0xFF000000);
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            __m256i alpha = _mm256_and_si256(s, alphaMask);
+
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(alpha, alphaMask)) == -1) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), s);
+                continue;
+            }
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(alpha, zero)) == -1) {
+                continue;
+            }
+
+            // Unpack and pack both work within 128-bit lanes, so pixel order is kept
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+            __m256i lo = Blend2x4(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero));
+            __m256i hi = Blend2x4(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero));
+            __m256i result = _mm256_add_epi8(s, _mm256_packus_epi16(lo, hi));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), result);
+        }
+
+        // Legacy SSE code runs slowly while the upper halves are dirty, and
+        // compilers skip the vzeroupper when the tail call becomes a jump
+        _mm256_zeroupper();
+        BlendSSE2(src + i, dst + i, count - i);
+    }
+#endif
+
+    inline void BlendSpan(const Uint32* src, Uint32* dst, int count, SimdLevel level) {
+#ifdef SIMD_DISPATCH
+        if (level >= SimdLevel::AVX2) {
+            BlendAVX2(src, dst, count);
+            return;
+        }
+#endif
+#ifdef RASTER_SSE2
+        if (level >= SimdLevel::SSE2) {
+            BlendSSE2(src, dst, count);
+            return;
+        }
+#endif
+        BlendScalar(src, dst, count);
+    }
+
+    inline Uint32 Premultiply(Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+        return Div255(r * a) | (Div255(g * a) << 8) | (Div255(b * a) << 16) | ((Uint32)a << 24);
+    }
+}
+
+void RasterImage::Convert(const ImageInfo* info) {
+    Width = info->Width;
+    Height = info->Height;
+    Pixels.resize((size_t)Width * Height);
+
+    // Cooked textures are already in this format
+    if (info->Premultiplied && info->BitsPerPixel == 32) {
+        memcpy(Pixels.data(), info->Data, Pixels.size() * sizeof(Uint32));
+        return;
+    }
+
+    const int channels = info->BitsPerPixel / 8;
+    const unsigned char* data = info->Data;
+    for (size_t i = 0; i < Pixels.size(); ++i, data += channels) {
+        Uint8 alpha = (channels == 4) ? data[3] : 255;
+        Pixels[i] = Premultiply(data[0], data[1], data[2], alpha);
+    }
+}
+
+SoftwareRasterizer::SoftwareRasterizer()
+    : m_width(0), m_height(0), m_tileColumns(0), m_tileRows(0) {
+}
+
+void SoftwareRasterizer::Resize(int width, int height) {
+    m_width = width;
+    m_height = height;
+    m_tileColumns = (width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tileRows = (height + TILE_SIZE - 1) / TILE_SIZE;
+    m_pixels.assign((size_t)width * height, 0);
+}
+
+void SoftwareRasterizer::SetThreadCount(unsigned int threads) {
+    if (threads == 1) {
+        m_workers.reset();
+        return;
+    }
+    m_workers.reset(new WorkerPool(threads == 0 ? 0 : threads - 1));
+}
+
+bool SoftwareRasterizer::ClipBounds(const SDL_FRect& dest, const SDL_Rect* clip,
+                                    int& x0, int& y0, int& x1, int& y1) const {
+    // A pixel is covered when its centre lies inside dest
+    x0 = (int)std::ceil(dest.x - 0.5f);
+    y0 = (int)std::ceil(dest.y - 0.5f);
+    x1 = (int)std::ceil(dest.x + dest.w - 0.5f);
+    y1 = (int)std::ceil(dest.y + dest.h - 0.5f);
+
+    int cx0 = 0, cy0 = 0, cx1 = m_width, cy1 = m_height;
+    if (clip) {
+        cx0 = std::max(cx0, clip->x);
+        cy0 = std::max(cy0, clip->y);
+        cx1 = std::min(cx1, clip->x + clip->w);
+        cy1 = std::min(cy1, clip->y + clip->h);
+    }
+
+    x0 = std::max(x0, cx0);
+    y0 = std::max(y0, cy0);
+    x1 = std::min(x1, cx1);
+    y1 = std::min(y1, cy1);
+    return x0 < x1 && y0 < y1;
+}
+
+void SoftwareRasterizer::Clear(SDL_Color color, const SDL_Rect* clip) {
+    SDL_FRect all = {0.0f, 0.0f, (float)m_width, (float)m_height};
+    int x0, y0, x1, y1;
+    if (!ClipBounds(all, clip, x0, y0, x1, y1)) {
+        return;
+    }
+
+    // Clearing replaces pixels rather than blending, like SDL_RenderClear
+    Uint32 value = color.r | (color.g << 8) | (color.b << 16) | ((Uint32)color.a << 24);
+    for (int y = y0; y < y1; ++y) {
+        std::fill(m_pixels.begin() + (size_t)y * m_width + x0,
+                  m_pixels.begin() + (size_t)y * m_width + x1, value);
+    }
+}
+
+void SoftwareRasterizer::DrawImage(const RasterImage& image, const SDL_FRect& src,
+                                   const SDL_FRect& dest, const SDL_Rect* clip) {
+    int x0, y0, x1, y1;
+    if (dest.w <= 0.0f || dest.h <= 0.0f || !ClipBounds(dest, clip, x0, y0, x1, y1)) {
+        return;
+    }
+
+    // Source texel bounds, clamped to the image
+    int srcLeft = std::max(0, (int)src.x);
+    int srcTop = std::max(0, (int)src.y);
+    int srcRight = std::min(image.Width, (int)(src.x + src.w)) - 1;
+    int srcBottom = std::min(image.Height, (int)(src.y + src.h)) - 1;
+    if (srcLeft > srcRight || srcTop > srcBottom) {
+        return;
+    }
+
+    // Nearest texel for each pixel centre, stepped in 32.32 fixed point
+    const double ONE = 4294967296.0;
+    const double scaleX = src.w / dest.w;
+    const double scaleY = src.h / dest.h;
+    const Sint64 stepU = (Sint64)(scaleX * ONE);
+    const Sint64 startU = (Sint64)std::floor((src.x + (x0 + 0.5 - dest.x) * scaleX) * ONE);
+    const bool unscaled = (stepU == (1ll << 32));
+
+    const SimdLevel level = CpuFeatures::GetSimdLevel();
+    Uint32 span[CHUNK];
+    for (int y = y0; y < y1; ++y) {
+        int v = (int)std::floor(src.y + (y + 0.5 - dest.y) * scaleY);
+        v = std::min(std::max(v, srcTop), srcBottom);
+        const Uint32* srcRow = image.Pixels.data() + (size_t)v * image.Width;
+        Uint32* dstRow = m_pixels.data() + (size_t)y * m_width;
+
+        for (int x = x0; x < x1; x += CHUNK) {
+            int count = std::min(CHUNK, x1 - x);
+            Sint64 u = startU + (x - x0) * stepU;
+
+            // 1:1 draws read the source row in place; scaled ones gather first
+            const Uint32* pixels;
+            int first = (int)(u >> 32);
+            if (unscaled && first >= srcLeft && first + count - 1 <= srcRight) {
+                pixels = srcRow + first;
+            } else {
+                for (int i = 0; i < count; ++i, u += stepU) {
+                    int texel = (int)(u >> 32);
+                    span[i] = srcRow[std::min(std::max(texel, srcLeft), srcRight)];
+                }
+                pixels = span;
+            }
+
+            BlendSpan(pixels, dstRow + x, count, level);
+        }
+    }
+}
+
+void SoftwareRasterizer::FillBlended(int x0, int y0, int x1, int y1, Uint32 color) {
+    const SimdLevel level = CpuFeatures::GetSimdLevel();
+    Uint32 span[CHUNK];
+    std::fill(span, span + CHUNK, color);
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; x += CHUNK) {
+            BlendSpan(span, m_pixels.data() + (size_t)y * m_width + x, std::min(CHUNK, x1 - x), level);
+        }
+    }
+}
+
+void SoftwareRasterizer::DrawRect(const SDL_FRect& dest, SDL_Color color, const SDL_Rect* clip) {
+    if (dest.w <= 0.0f || dest.h <= 0.0f) {
+        return;
+    }
+
+    // Edges sit on the unclipped rect; clipping applies to each edge
+    int left = (int)std::ceil(dest.x - 0.5f);
+    int top = (int)std::ceil(dest.y - 0.5f);
+    int right = (int)std::ceil(dest.x + dest.w - 0.5f);
+    int bottom = (int)std::ceil(dest.y + dest.h - 0.5f);
+    if (left >= right || top >= bottom) {
+        return;
+    }
+
+    int cx0 = 0, cy0 = 0, cx1 = m_width, cy1 = m_height;
+    if (clip) {
+        cx0 = std::max(cx0, clip->x);
+        cy0 = std::max(cy0, clip->y);
+        cx1 = std::min(cx1, clip->x + clip->w);
+        cy1 = std::min(cy1, clip->y + clip->h);
+    }
+
+    // Top and bottom rows, then the left and right columns between them
+    Uint32 value = Premultiply(color.r, color.g, color.b, color.a);
+    const int edges[4][4] = {
+        {left, top, right, top + 1},
+        {left, bottom - 1, right, bottom},
+        {left, top + 1, left + 1, bottom - 1},
+        {right - 1, top + 1, right, bottom - 1},
+    };
+    for (int e = 0; e < 4; ++e) {
+        if (e == 1 && bottom - 1 == top) break;
+        if (e == 3 && right - 1 == left) break;
+        int x0 = std::max(edges[e][0], cx0), y0 = std::max(edges[e][1], cy0);
+        int x1 = std::min(edges[e][2], cx1), y1 = std::min(edges[e][3], cy1);
+        if (x0 < x1 && y0 < y1) {
+            FillBlended(x0, y0, x1, y1, value);
+        }
+    }
+}
+
+void SoftwareRasterizer::DrawBatch(const std::vector<RasterDraw>& draws,
+                                   const std::vector<SDL_Rect>& regions, SDL_Color clearColor) {
+    const int tileCount = m_tileColumns * m_tileRows;
+    m_tileStart.assign(tileCount + 1, 0);
+
+    // Count, prefix-sum, then fill, so each tile's list stays in draw order
+    int x0, y0, x1, y1;
+    for (const RasterDraw& draw : draws) {
+        if (!ClipBounds(draw.Dest, nullptr, x0, y0, x1, y1)) continue;
+        for (int ty = y0 / TILE_SIZE; ty <= (y1 - 1) / TILE_SIZE; ++ty) {
+            for (int tx = x0 / TILE_SIZE; tx <= (x1 - 1) / TILE_SIZE; ++tx) {
+                m_tileStart[ty * m_tileColumns + tx + 1]++;
+            }
+        }
+    }
+
+    for (int t = 0; t < tileCount; ++t) {
+        m_tileStart[t + 1] += m_tileStart[t];
+    }
+
+    m_tileDraws.resize(m_tileStart[tileCount]);
+    m_tileCursor.assign(m_tileStart.begin(), m_tileStart.end() - 1);
+    for (size_t i = 0; i < draws.size(); ++i) {
+        if (!ClipBounds(draws[i].Dest, nullptr, x0, y0, x1, y1)) continue;
+        for (int ty = y0 / TILE_SIZE; ty <= (y1 - 1) / TILE_SIZE; ++ty) {
+            for (int tx = x0 / TILE_SIZE; tx <= (x1 - 1) / TILE_SIZE; ++tx) {
+                m_tileDraws[m_tileCursor[ty * m_tileColumns + tx]++] = (int)i;
+            }
+        }
+    }
+
+    // Tiles write disjoint pixels, so they need no synchronisation
+    auto job = [&](size_t tile) { DrawTile((int)tile, draws, regions, clearColor); };
+    if (m_workers) {
+        m_workers->ParallelFor(tileCount, job);
+    } else {
+        for (int t = 0; t < tileCount; ++t) job(t);
+    }
+}
+
+void SoftwareRasterizer::DrawTile(int tile, const std::vector<RasterDraw>& draws,
+                                  const std::vector<SDL_Rect>& regions, SDL_Color clearColor) {
+    int left = (tile % m_tileColumns) * TILE_SIZE;
+    int top = (tile / m_tileColumns) * TILE_SIZE;
+    int right = std::min(left + TILE_SIZE, m_width);
+    int bottom = std::min(top + TILE_SIZE, m_height);
+
+    // Regions don't overlap, so every pixel is cleared and drawn at most once
+    for (const SDL_Rect& region : regions) {
+        SDL_Rect clip;
+        clip.x = std::max(left, region.x);
+        clip.y = std::max(top, region.y);
+        clip.w = std::min(right, region.x + region.w) - clip.x;
+        clip.h = std::min(bottom, region.y + region.h) - clip.y;
+        if (clip.w <= 0 || clip.h <= 0) continue;
+
+        Clear(clearColor, &clip);
+        for (int k = m_tileStart[tile]; k < m_tileStart[tile + 1]; ++k) {
+            const RasterDraw& draw = draws[m_tileDraws[k]];
+            if (draw.Image) {
+                DrawImage(*draw.Image, draw.Src, draw.Dest, &clip);
+            } else {
+                DrawRect(draw.Dest, draw.Color, &clip);
+            }
+        }
+    }
+}
@@ -0,0 +1,142 @@
+#include "../Include/StackAllocator.h"
+#include "../Include/Log.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Huge pages are 2 MB on x86-64 and most ARM64 configurations
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// Commit in steps of at least this much so small allocations don't each
+// make a system call
+static const size_t MIN_COMMIT = 64 * 1024;
+
+static size_t AlignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+StackAllocator::StackAllocator(size_t reserveSize, MemoryTag tag, bool hugePages)
+    : m_base(nullptr), m_size(0), m_used(0), m_committed(0), m_commitGranularity(MIN_COMMIT), m_tag(tag) {
+#ifdef _WIN32
+    // Large pages on Windows need a privilege most accounts lack
+    (void)hugePages;
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    m_commitGranularity = AlignUp(MIN_COMMIT, info.dwPageSize);
+    reserveSize = AlignUp(reserveSize, m_commitGranularity);
+
+    void* base = VirtualAlloc(nullptr, reserveSize, MEM_RESERVE, PAGE_NOACCESS);
+    if (!base) {
+        LOG_ERROR("Failed to reserve %zu bytes of address space", reserveSize);
+        return;
+    }
+    m_base = static_cast<char*>(base);
+#else
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    m_commitGranularity = AlignUp(hugePages ? HUGE_PAGE_SIZE : MIN_COMMIT, pageSize);
+    reserveSize = AlignUp(reserveSize, m_commitGranularity);
+
+    // Over-reserve by one huge page so the range can start on a huge page boundary
+    size_t mapSize = reserveSize + (hugePages ? HUGE_PAGE_SIZE : 0);
+    void* mapping = mmap(nullptr, mapSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapping == MAP_FAILED) {
+        LOG_ERROR("Failed to reserve %zu bytes of address space", reserveSize);
+        return;
+    }
+
+    char* base = static_cast<char*>(mapping);
+    if (hugePages) {
+        char* aligned = reinterpret_cast<char*>(AlignUp(reinterpret_cast<size_t>(base), HUGE_PAGE_SIZE));
+        size_t head = aligned - base;
+        if (head > 0) {
+            munmap(base, head);
+        }
+        munmap(aligned + reserveSize, HUGE_PAGE_SIZE - head);
+        base = aligned;
+
+#ifdef MADV_HUGEPAGE
+        // A hint: the kernel backs committed 2 MB runs with huge pages when it can
+        madvise(base, reserveSize, MADV_HUGEPAGE);
+#endif
+    }
+    m_base = base;
+#endif
+
+    m_size = reserveSize;
+}
+
+StackAllocator::~StackAllocator() {
+    if (!m_base) {
+        return;
+    }
+
+    MemoryTracker::RecordResize(m_tag, m_committed, 0);
+#ifdef _WIN32
+    VirtualFree(m_base, 0, MEM_RELEASE);
+#else
+    munmap(m_base, m_size);
+#endif
+}
+
+void* StackAllocator::Allocate(size_t size) {
+    size_t start = AlignUp(m_used, alignof(std::max_align_t));
+    if (!m_base || size > m_size - std::min(start, m_size)) {
+        return nullptr; // Out of memory
+    }
+
+    if (start + size > m_committed && !Commit(start + size)) {
+        return nullptr;
+    }
+
+    m_used = start + size;
+    return m_base + start;
+}
+
+bool StackAllocator::Commit(size_t end) {
+    size_t target = std::min(AlignUp(end, m_commitGranularity), m_size);
+    size_t grow = target - m_committed;
+
+#ifdef _WIN32
+    if (!VirtualAlloc(m_base + m_committed, grow, MEM_COMMIT, PAGE_READWRITE)) {
+        return false;
+    }
+#else
+    if (mprotect(m_base + m_committed, grow, PROT_READ | PROT_WRITE) != 0) {
+        return false;
+    }
+#endif
+
+    MemoryTracker::RecordResize(m_tag, m_committed, target);
+    m_committed = target;
+    return true;
+}
+
+void StackAllocator::Decommit() {
+    if (m_committed == 0) {
+        return;
+    }
+
+#ifdef _WIN32
+    VirtualFree(m_base, m_committed, MEM_DECOMMIT);
+#else
+    // Drop the pages first so they stop counting toward RSS, then make the
+    // range inaccessible again until it's recommitted
+    madvise(m_base, m_committed, MADV_DONTNEED);
+    mprotect(m_base, m_committed, PROT_NONE);
+#endif
+
+    MemoryTracker::RecordResize(m_tag, m_committed, 0);
+    m_committed = 0;
+}
+
+void StackAllocator::Clear() {
+    m_used = 0;
+    Decommit();
+}
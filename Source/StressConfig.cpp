@@ -0,0 +1,102 @@
+#include "../Include/StressConfig.h"
+#include "../Include/FileController.h"
+#include "../Include/Log.h"
+#include <sstream>
+#include <stdexcept>
+
+bool SpeedDistribution::Parse(const std::string& spec) {
+    std::istringstream tokens(spec);
+    std::string kind, a, b;
+    if (!std::getline(tokens, kind, ':') || !std::getline(tokens, a, ':') ||
+        !std::getline(tokens, b, ':')) {
+        return false;
+    }
+
+    if (kind == "uniform") {
+        Kind = Type::UNIFORM;
+    } else if (kind == "normal") {
+        Kind = Type::NORMAL;
+    } else {
+        return false;
+    }
+
+    A = std::stof(a);
+    B = std::stof(b);
+    return true;
+}
+
+float SpeedDistribution::Sample(std::mt19937& gen) const {
+    float speed;
+    if (Kind == Type::UNIFORM) {
+        speed = std::uniform_real_distribution<float>(A, B)(gen);
+    } else {
+        speed = std::normal_distribution<float>(A, B)(gen);
+    }
+
+    // Entities must keep moving forward or they never leave to respawn
+    return std::max(speed, 1.0f);
+}
+
+StressConfig::StressConfig()
+    : Warriors(1000), Rocks(1000), Density(1.0f),
+      WarriorSpeed(SpeedDistribution::Type::UNIFORM, 80.0f, 100.0f),
+      RockSpeed(SpeedDistribution::Type::UNIFORM, 80.0f, 100.0f),
+      Seed(0), Duration(0.0f), Collisions(true) {
+}
+
+bool StressConfig::LoadFromFile(const std::string& filepath) {
+    FileView data;
+    if (!FileController::GetInstance()->OpenFile(filepath, data)) {
+        return false;
+    }
+
+    std::istringstream file(std::string(data.Data, data.Data + data.Size));
+    std::string line;
+    bool ok = true;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            continue;
+        }
+
+        std::istringstream key(line.substr(0, equals));
+        std::istringstream value(line.substr(equals + 1));
+        std::string keyText, valueText;
+        key >> keyText;
+        value >> valueText;
+        ok = Set(keyText, valueText) && ok;
+    }
+
+    return ok;
+}
+
+bool StressConfig::Set(const std::string& key, const std::string& value) {
+    try {
+        if (key == "warriors") {
+            Warriors = std::max(0, std::stoi(value));
+        } else if (key == "rocks") {
+            Rocks = std::max(0, std::stoi(value));
+        } else if (key == "density") {
+            Density = std::max(0.01f, std::stof(value));
+        } else if (key == "warrior-speed") {
+            if (!WarriorSpeed.Parse(value)) throw std::invalid_argument(value);
+        } else if (key == "rock-speed") {
+            if (!RockSpeed.Parse(value)) throw std::invalid_argument(value);
+        } else if (key == "seed") {
+            Seed = (unsigned int)std::stoul(value);
+        } else if (key == "duration") {
+            Duration = std::stof(value);
+        } else if (key == "collisions") {
+            Collisions = (value != "0" && value != "false");
+        } else {
+            LOG_ERROR("Unknown stress setting: %s", key.c_str());
+            return false;
+        }
+    } catch (const std::exception&) {
+        LOG_ERROR("Invalid value for stress setting %s: %s", key.c_str(), value.c_str());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,215 @@
+#include "../Include/StressLevel.h"
+#include "../Include/RenderQueue.h"
+#include "../Include/Metrics.h"
+
+StressLevel::StressLevel(const StressConfig& config)
+    : Level(3), m_config(config), m_durationReached(false) {
+    m_backgroundColor = {64, 64, 64, 255}; // Dark grey
+
+    if (m_config.Seed != 0) {
+        m_gen.seed(m_config.Seed);
+    } else {
+        std::random_device rd;
+        m_gen.seed(rd());
+    }
+}
+
+StressLevel::~StressLevel() {
+    ReleaseAll(m_rocks, m_world->GetRockPool());
+}
+
+void StressLevel::Initialize() {
+    for (int i = 0; i < m_config.Warriors; i++) {
+        Warrior* warrior = m_world->GetWarriorPool()->GetResource();
+        SpawnWarrior(warrior);
+        m_warriors.push_back(warrior);
+    }
+
+    for (int i = 0; i < m_config.Rocks; i++) {
+        Rock* rock = m_world->GetRockPool()->GetResource();
+        SpawnRock(rock);
+        m_rocks.push_back(rock);
+    }
+
+    m_gameTime = 0.0f;
+    m_autoSaved = false;
+
+    m_durationReached = false;
+    if (m_config.Duration > 0.0f) {
+        StartTask(RunForDuration());
+    }
+}
+
+Task StressLevel::RunForDuration() {
+    co_await Seconds(m_config.Duration);
+    m_durationReached = true;
+}
+
+void StressLevel::SpawnWarrior(Warrior* warrior) {
+    const float scale = 1.8f;
+
+    // Stagger entry off the left edge; the band narrows as density rises
+    float lead = std::uniform_real_distribution<float>(0.0f, 1920.0f / m_config.Density)(m_gen);
+    float yPos = std::uniform_real_distribution<float>(0.0f, 1080.0f - 64.0f * scale)(m_gen);
+    float speed = m_config.WarriorSpeed.Sample(m_gen);
+    float animSpeed = speed * 0.06f;  // Same 4.8-6.0 fps at 80-100 px/s as Level1
+
+    warrior->Initialize(-100.0f - lead, yPos, speed, animSpeed, scale);
+}
+
+void StressLevel::SpawnRock(Rock* rock) {
+    const float scale = 1.0f;
+
+    float lead = std::uniform_real_distribution<float>(0.0f, 1080.0f / m_config.Density)(m_gen);
+    float xPos = std::uniform_real_distribution<float>(0.0f, 1920.0f - 64.0f * scale)(m_gen);
+    float speed = m_config.RockSpeed.Sample(m_gen);
+    float animSpeed = speed * 0.06f;
+
+    rock->Initialize(xPos, -100.0f - lead, speed, animSpeed, scale);
+}
+
+void StressLevel::Update(float deltaTime) {
+    AdvanceTime(deltaTime);
+
+    m_world->GetMotion()->Update(deltaTime);
+    m_world->GetTransforms()->Update();
+
+    if (m_config.Collisions) {
+        CheckCollisions(deltaTime);
+    }
+
+    // Recycle in place so the population stays constant. A respawn queues
+    // a transform change, after which world positions can't be read until
+    // the next update, so every check runs before any respawn.
+    m_respawns.clear();
+    for (size_t i = 0; i < m_warriors.size(); ++i) {
+        if (m_warriors[i]->IsOffScreen() || m_warriors[i]->IsDead()) {
+            m_respawns.push_back(i);
+        }
+    }
+    size_t warriorRespawns = m_respawns.size();
+    for (size_t i = 0; i < m_rocks.size(); ++i) {
+        if (m_rocks[i]->IsOffScreen() || !m_rocks[i]->IsActive()) {
+            m_respawns.push_back(i);
+        }
+    }
+
+    for (size_t k = 0; k < warriorRespawns; ++k) {
+        SpawnWarrior(m_warriors[m_respawns[k]]);
+    }
+    for (size_t k = warriorRespawns; k < m_respawns.size(); ++k) {
+        SpawnRock(m_rocks[m_respawns[k]]);
+    }
+}
+
+void StressLevel::Render(FramePacket* packet) {
+    for (Warrior* warrior : m_warriors) {
+        warrior->Render(packet);
+    }
+
+    for (Rock* rock : m_rocks) {
+        rock->Render(packet);
+    }
+}
+
+bool StressLevel::GetCellRange(float x, float y, float w, float h,
+                               int& minCol, int& minRow, int& maxCol, int& maxRow) const {
+    minCol = std::max(0, (int)std::floor(x / CELL_SIZE));
+    minRow = std::max(0, (int)std::floor(y / CELL_SIZE));
+    maxCol = std::min(GRID_COLUMNS - 1, (int)std::floor((x + w) / CELL_SIZE));
+    maxRow = std::min(GRID_ROWS - 1, (int)std::floor((y + h) / CELL_SIZE));
+    return minCol <= maxCol && minRow <= maxRow;
+}
+
+void StressLevel::CheckCollisions(float deltaTime) {
+    // Brute force is O(warriors * rocks); bin on-screen warriors into a
+    // uniform grid so each rock only tests its neighbours. Boxes are
+    // extended back over this step's motion so swept tests see every pair.
+    const int cellCount = GRID_COLUMNS * GRID_ROWS;
+    m_cellStart.assign(cellCount + 1, 0);
+
+    int minCol, minRow, maxCol, maxRow;
+    for (Warrior* w : m_warriors) {
+        float travel = w->GetVelocityX() * deltaTime;
+        if (!w->IsAlive() ||
+            !GetCellRange(w->GetX() - travel, w->GetY(), w->GetWidth() + travel, w->GetHeight(),
+                          minCol, minRow, maxCol, maxRow)) continue;
+        for (int row = minRow; row <= maxRow; ++row) {
+            for (int col = minCol; col <= maxCol; ++col) {
+                m_cellStart[row * GRID_COLUMNS + col + 1]++;
+            }
+        }
+    }
+
+    for (int c = 0; c < cellCount; ++c) {
+        m_cellStart[c + 1] += m_cellStart[c];
+    }
+
+    m_cellWarriors.resize(m_cellStart[cellCount]);
+    std::vector<int> cursor(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (size_t i = 0; i < m_warriors.size(); ++i) {
+        Warrior* w = m_warriors[i];
+        float travel = w->GetVelocityX() * deltaTime;
+        if (!w->IsAlive() ||
+            !GetCellRange(w->GetX() - travel, w->GetY(), w->GetWidth() + travel, w->GetHeight(),
+                          minCol, minRow, maxCol, maxRow)) continue;
+        for (int row = minRow; row <= maxRow; ++row) {
+            for (int col = minCol; col <= maxCol; ++col) {
+                m_cellWarriors[cursor[row * GRID_COLUMNS + col]++] = (int)i;
+            }
+        }
+    }
+
+    float time;
+    uint64_t tests = 0;
+    for (Rock* rock : m_rocks) {
+        float travel = rock->GetVelocityY() * deltaTime;
+        if (!rock->IsActive() ||
+            !GetCellRange(rock->GetX(), rock->GetY() - travel, rock->GetWidth(), rock->GetHeight() + travel,
+                          minCol, minRow, maxCol, maxRow)) continue;
+
+        // A warrior spanning several cells may be reported more than once;
+        // ResolveContacts ignores pairs that have already collided
+        for (int row = minRow; row <= maxRow; ++row) {
+            for (int col = minCol; col <= maxCol; ++col) {
+                int cell = row * GRID_COLUMNS + col;
+                tests += m_cellStart[cell + 1] - m_cellStart[cell];
+                for (int k = m_cellStart[cell]; k < m_cellStart[cell + 1]; ++k) {
+                    Warrior* warrior = m_warriors[m_cellWarriors[k]];
+                    if (SweepAABB(warrior, rock, deltaTime, time)) {
+                        m_contacts.push_back({time, warrior, rock});
+                    }
+                }
+            }
+        }
+    }
+
+    Metrics::Add(Metric::COLLISION_TESTS, tests);
+    Metrics::Add(Metric::COLLISION_HITS, m_contacts.size());
+    ResolveContacts(m_contacts);
+}
+
+void StressLevel::Serialize(std::ostream& stream) {
+    Level::Serialize(stream);
+
+    size_t rockCount = m_rocks.size();
+    stream.write(reinterpret_cast<const char*>(&rockCount), sizeof(size_t));
+
+    for (Rock* rock : m_rocks) {
+        rock->Serialize(stream);
+    }
+}
+
+void StressLevel::Deserialize(std::istream& stream) {
+    Level::Deserialize(stream);
+
+    size_t rockCount;
+    stream.read(reinterpret_cast<char*>(&rockCount), sizeof(size_t));
+
+    ReleaseAll(m_rocks, m_world->GetRockPool());
+    for (size_t i = 0; i < rockCount; ++i) {
+        Rock* rock = m_world->GetRockPool()->GetResource();
+        rock->Deserialize(stream);
+        m_rocks.push_back(rock);
+    }
+}
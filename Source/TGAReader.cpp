@@ -1,22 +1,27 @@
 #include "../Include/TGAReader.h"
 #include "../Include/FileController.h"
+#include "../Include/MemoryTracker.h"
+#include "../Include/Log.h"
 
 ImageInfo* TGAReader::ReadTGA(const std::string& filepath) {
-    std::vector<unsigned char> fileData;
-    if (!FileController::GetInstance()->ReadFile(filepath, fileData)) {
+    // Runs on loader threads too, so tag here rather than at the callers
+    MemoryScope scope(MemoryTag::TEXTURES);
+
+    FileView fileData;
+    if (!FileController::GetInstance()->OpenFile(filepath, fileData)) {
         return nullptr;
     }
 
-    if (fileData.size() < sizeof(TGAHeader)) {
-        std::cerr << "Invalid TGA file: " << filepath << std::endl;
+    if (fileData.Size < sizeof(TGAHeader)) {
+        LOG_ERROR("Invalid TGA file: %s", filepath.c_str());
         return nullptr;
     }
 
-    TGAHeader* header = reinterpret_cast<TGAHeader*>(fileData.data());
+    const TGAHeader* header = reinterpret_cast<const TGAHeader*>(fileData.Data);
 
     // Support uncompressed RGB/RGBA
     if (header->imageType != 2) { // Type 2 = Uncompressed True-color
-        std::cerr << "Unsupported TGA image type: " << (int)header->imageType << std::endl;
+        LOG_ERROR("Unsupported TGA image type: %d", (int)header->imageType);
         return nullptr;
     }
 
@@ -25,7 +30,7 @@ ImageInfo* TGAReader::ReadTGA(const std::string& filepath) {
     int bpp = header->bitsPerPixel;
 
     if (bpp != 24 && bpp != 32) {
-        std::cerr << "Unsupported TGA bit depth: " << bpp << std::endl;
+        LOG_ERROR("Unsupported TGA bit depth: %d", bpp);
         return nullptr;
     }
 
@@ -36,22 +41,28 @@ ImageInfo* TGAReader::ReadTGA(const std::string& filepath) {
     int dataOffset = sizeof(TGAHeader) + header->idLength + 
                      (header->colorMapType ? header->colorMapLength * (header->colorMapDepth / 8) : 0);
 
-    if (fileData.size() < dataOffset + imageSize) {
-        std::cerr << "Invalid TGA file size: " << filepath << std::endl;
+    if (fileData.Size < (size_t)(dataOffset + imageSize)) {
+        LOG_ERROR("Invalid TGA file size: %s", filepath.c_str());
         return nullptr;
     }
 
-    // Allocate and copy image data (convert BGR to RGB)
+    // Allocate and copy image data (convert BGR to RGB), top row first;
+    // TGAs are stored bottom row first unless descriptor bit 5 is set
     unsigned char* imageData = new unsigned char[imageSize];
-    unsigned char* src = fileData.data() + dataOffset;
-
-    for (int i = 0; i < width * height; ++i) {
-        int idx = i * bytesPerPixel;
-        imageData[idx + 0] = src[idx + 2]; // R
-        imageData[idx + 1] = src[idx + 1]; // G
-        imageData[idx + 2] = src[idx + 0]; // B
-        if (bpp == 32) {
-            imageData[idx + 3] = src[idx + 3]; // A
+    const unsigned char* src = fileData.Data + dataOffset;
+    const bool bottomUp = (header->imageDescriptor & 0x20) == 0;
+    const int rowBytes = width * bytesPerPixel;
+
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* srcRow = src + (size_t)(bottomUp ? height - 1 - y : y) * rowBytes;
+        unsigned char* dstRow = imageData + (size_t)y * rowBytes;
+        for (int x = 0; x < rowBytes; x += bytesPerPixel) {
+            dstRow[x + 0] = srcRow[x + 2]; // R
+            dstRow[x + 1] = srcRow[x + 1]; // G
+            dstRow[x + 2] = srcRow[x + 0]; // B
+            if (bpp == 32) {
+                dstRow[x + 3] = srcRow[x + 3]; // A
+            }
         }
     }
 
@@ -63,3 +74,42 @@ ImageInfo* TGAReader::ReadTGA(const std::string& filepath) {
 
     return info;
 }
+
+bool TGAReader::ReadTGAHeader(const std::string& filepath, int& width, int& height, int& bitsPerPixel) {
+    TGAHeader header;
+    if (!FileController::GetInstance()->ReadFileHeader(filepath, &header, sizeof(TGAHeader))) {
+        return false;
+    }
+
+    if (header.imageType != 2 || (header.bitsPerPixel != 24 && header.bitsPerPixel != 32)) {
+        LOG_ERROR("Unsupported TGA file: %s", filepath.c_str());
+        return false;
+    }
+
+    width = header.width;
+    height = header.height;
+    bitsPerPixel = header.bitsPerPixel;
+    return true;
+}
+
+void TGAReader::EncodeTGA(const unsigned char* rgba, int width, int height, std::vector<unsigned char>& out) {
+    TGAHeader header = {};
+    header.imageType = 2;
+    header.width = (unsigned short)width;
+    header.height = (unsigned short)height;
+    header.bitsPerPixel = 32;
+    header.imageDescriptor = 0x28; // 8 alpha bits, top-left origin
+
+    size_t pixelCount = (size_t)width * height;
+    out.resize(sizeof(TGAHeader) + pixelCount * 4);
+    memcpy(out.data(), &header, sizeof(TGAHeader));
+
+    // Convert RGBA to TGA's BGRA
+    unsigned char* dst = out.data() + sizeof(TGAHeader);
+    for (size_t i = 0; i < pixelCount; ++i) {
+        dst[i * 4 + 0] = rgba[i * 4 + 2];
+        dst[i * 4 + 1] = rgba[i * 4 + 1];
+        dst[i * 4 + 2] = rgba[i * 4 + 0];
+        dst[i * 4 + 3] = rgba[i * 4 + 3];
+    }
+}
@@ -0,0 +1,112 @@
+#include "../Include/Task.h"
+#include "../Include/Log.h"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+
+void Task::promise_type::unhandled_exception() {
+    LOG_ERROR("Unhandled exception in a task");
+    std::terminate();
+}
+
+Task& Task::operator=(Task&& other) noexcept {
+    if (this != &other) {
+        if (m_handle) {
+            m_handle.destroy();
+        }
+        m_handle = other.m_handle;
+        other.m_handle = nullptr;
+    }
+    return *this;
+}
+
+Task::~Task() {
+    if (m_handle) {
+        m_handle.destroy();
+    }
+}
+
+void Task::Start(EventScheduler& scheduler) {
+    // The task may start others, which can move this Task, so nothing here
+    // touches it after resuming
+    Handle handle = m_handle;
+    handle.promise().Scheduler = &scheduler;
+    handle.resume();
+}
+
+Seconds::~Seconds() {
+    // Only still set if the task was destroyed mid-wait
+    if (m_scheduler) {
+        m_scheduler->Cancel(m_event);
+    }
+}
+
+void Seconds::await_suspend(Task::Handle handle) {
+    m_scheduler = handle.promise().Scheduler;
+    m_event = m_scheduler->After(m_seconds, [this, handle] {
+        m_scheduler = nullptr;
+        handle.resume();
+    });
+}
+
+void TaskSignal::Notify() {
+    if (m_waiting.empty()) {
+        return;
+    }
+
+    // Resumed tasks may wait on this signal again or end other tasks'
+    // waits, so go through the waits as they were and skip any that ended
+    std::vector<Condition*> waiting(m_waiting);
+    for (Condition* condition : waiting) {
+        if (std::find(m_waiting.begin(), m_waiting.end(), condition) == m_waiting.end()) {
+            continue;
+        }
+
+        if (condition->m_predicate()) {
+            condition->Resume(true);
+        }
+    }
+}
+
+Condition::Condition(TaskSignal& signal, Predicate predicate, double timeout)
+    : m_signal(signal), m_predicate(std::move(predicate)), m_timeout(timeout), m_satisfied(false),
+      m_scheduler(nullptr), m_event(0) {
+}
+
+Condition::~Condition() {
+    Withdraw();
+}
+
+void Condition::await_suspend(Task::Handle handle) {
+    m_handle = handle;
+    m_signal.m_waiting.push_back(this);
+
+    if (std::isfinite(m_timeout)) {
+        m_scheduler = handle.promise().Scheduler;
+        m_event = m_scheduler->After(m_timeout, [this] {
+            m_scheduler = nullptr;
+            Resume(m_predicate());
+        });
+    }
+}
+
+void Condition::Withdraw() {
+    if (m_handle) {
+        std::vector<Condition*>& waiting = m_signal.m_waiting;
+        waiting.erase(std::find(waiting.begin(), waiting.end(), this));
+        m_handle = nullptr;
+    }
+
+    if (m_scheduler) {
+        m_scheduler->Cancel(m_event);
+        m_scheduler = nullptr;
+    }
+}
+
+void Condition::Resume(bool satisfied) {
+    // The task may destroy this awaiter once resumed, so finish with it first
+    Task::Handle handle = m_handle;
+    Withdraw();
+    m_satisfied = satisfied;
+    handle.resume();
+}
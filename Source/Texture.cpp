@@ -1,9 +1,14 @@
 #include "../Include/Texture.h"
 #include "../Include/TGAReader.h"
+#include "../Include/CookedTexture.h"
+#include "../Include/ResidencyManager.h"
+#include "../Include/AssetController.h"
 
 ObjectPool<Texture>* Texture::Pool = nullptr;
 
-Texture::Texture() : m_imageInfo(nullptr) {
+Texture::Texture()
+    : m_imageInfo(nullptr), m_width(0), m_height(0), m_bitsPerPixel(0),
+      m_lastUseFrame(0), m_registered(false) {
 }
 
 Texture::~Texture() {
@@ -12,35 +17,80 @@ Texture::~Texture() {
 
 bool Texture::Load(const std::string& filepath) {
     m_filepath = filepath;
-    m_imageInfo = TGAReader::ReadTGA(filepath);
-    return m_imageInfo != nullptr;
+    m_id = AssetId::Register(filepath);
+
+    std::string cookedPath;
+    m_cookedPath.clear();
+    if (CookedTexture::FindCooked(filepath, cookedPath) &&
+        CookedTexture::ReadHeader(cookedPath, m_width, m_height, m_bitsPerPixel)) {
+        m_cookedPath = cookedPath;
+    } else if (!TGAReader::ReadTGAHeader(filepath, m_width, m_height, m_bitsPerPixel)) {
+        return false;
+    }
+
+    ResidencyManager::GetInstance()->Register(this);
+    m_registered = true;
+    return true;
 }
 
-void Texture::Unload() {
+ImageInfo* Texture::Acquire() {
+    if (!m_imageInfo && m_registered) {
+        SetImageInfo(ResidencyManager::GetInstance()->Decode(this));
+    }
+    return m_imageInfo;
+}
+
+ImageInfo* Texture::ReadPixels(const std::string& filepath, const std::string& cookedPath) {
+    return cookedPath.empty() ? TGAReader::ReadTGA(filepath) : CookedTexture::Read(cookedPath);
+}
+
+void Texture::Evict() {
+    SetImageInfo(nullptr);
+}
+
+void Texture::Reload(ImageInfo* imageInfo) {
+    SetImageInfo(imageInfo);
+}
+
+void Texture::SetImageInfo(ImageInfo* imageInfo) {
     if (m_imageInfo) {
-        if (m_imageInfo->Data) {
+        ResidencyManager::GetInstance()->AdjustCpuBytes(-(long long)GetByteSize());
+        if (!m_imageInfo->Mapped) {
             delete[] m_imageInfo->Data;
         }
         delete m_imageInfo;
-        m_imageInfo = nullptr;
+    }
+
+    m_imageInfo = imageInfo;
+
+    if (m_imageInfo) {
+        m_width = m_imageInfo->Width;
+        m_height = m_imageInfo->Height;
+        m_bitsPerPixel = m_imageInfo->BitsPerPixel;
+        ResidencyManager::GetInstance()->AdjustCpuBytes((long long)GetByteSize());
+    }
+}
+
+void Texture::Unload() {
+    if (m_registered) {
+        Evict();
+        ResidencyManager::GetInstance()->Unregister(this);
+        m_registered = false;
     }
 }
 
 void Texture::Serialize(std::ostream& stream) {
-    size_t pathLen = m_filepath.length();
-    stream.write(reinterpret_cast<const char*>(&pathLen), sizeof(size_t));
-    stream.write(m_filepath.c_str(), pathLen);
+    // Saves store the 8-byte id rather than the path string
+    stream.write(reinterpret_cast<const char*>(&m_id.Value), sizeof(m_id.Value));
 }
 
 void Texture::Deserialize(std::istream& stream) {
-    size_t pathLen;
-    stream.read(reinterpret_cast<char*>(&pathLen), sizeof(size_t));
-    char* pathBuffer = new char[pathLen + 1];
-    stream.read(pathBuffer, pathLen);
-    pathBuffer[pathLen] = '\0';
-    m_filepath = pathBuffer;
-    delete[] pathBuffer;
+    AssetId id;
+    stream.read(reinterpret_cast<char*>(&id.Value), sizeof(id.Value));
 
     // Reload texture
-    Load(m_filepath);
+    std::string filepath;
+    if (AssetController::GetInstance()->ResolvePath(id, filepath)) {
+        Load(filepath);
+    }
 }
@@ -0,0 +1,210 @@
+#include "../Include/TransformSystem.h"
+#include <algorithm>
+
+void TransformSystem::Reserve(size_t count) {
+    m_localX.reserve(count);
+    m_localY.reserve(count);
+    m_localScale.reserve(count);
+    m_worldX.reserve(count);
+    m_worldY.reserve(count);
+    m_worldScale.reserve(count);
+    m_parents.reserve(count);
+    m_firstChildren.reserve(count);
+    m_nextSiblings.reserve(count);
+    m_previousSiblings.reserve(count);
+    m_depths.reserve(count);
+    m_parentSlots.reserve(count);
+    m_dirty.reserve(count);
+
+    // A root and its children; every new node is queued once
+    if (m_dirtyByDepth.size() < 2) {
+        m_dirtyByDepth.resize(2);
+    }
+    for (std::vector<int>& queue : m_dirtyByDepth) {
+        queue.reserve(count);
+    }
+}
+
+int TransformSystem::CreateNode(int parent) {
+    int node;
+    if (!m_freeNodes.empty()) {
+        node = m_freeNodes.back();
+        m_freeNodes.pop_back();
+    } else {
+        node = (int)m_parents.size();
+        m_localX.push_back(0.0f);
+        m_localY.push_back(0.0f);
+        m_localScale.push_back(1.0f);
+        m_worldX.push_back(0.0f);
+        m_worldY.push_back(0.0f);
+        m_worldScale.push_back(1.0f);
+        m_parents.push_back(-1);
+        m_firstChildren.push_back(-1);
+        m_nextSiblings.push_back(-1);
+        m_previousSiblings.push_back(-1);
+        m_depths.push_back(0);
+        m_parentSlots.push_back(-1);
+        m_dirty.push_back(0);
+    }
+
+    m_localX[node] = m_worldX[node] = 0.0f;
+    m_localY[node] = m_worldY[node] = 0.0f;
+    m_localScale[node] = m_worldScale[node] = 1.0f;
+    m_firstChildren[node] = -1;
+    m_dirty[node] = 0;
+    Attach(node, parent);
+    m_depths[node] = parent >= 0 ? m_depths[parent] + 1 : 0;
+
+    // Picks up its parent's world transform on the next update
+    MarkDirty(node);
+    return node;
+}
+
+void TransformSystem::ReleaseNode(int node) {
+    int parent = m_parents[node];
+    int depth = m_depths[node];
+    Detach(node);
+
+    while (m_firstChildren[node] >= 0) {
+        int child = m_firstChildren[node];
+        Detach(child);
+        Attach(child, parent);
+        Reroot(child, depth);
+        MarkDirty(child);
+    }
+
+    // Any queued entry is skipped from here on
+    m_depths[node] = -1;
+    m_dirty[node] = 0;
+    m_freeNodes.push_back(node);
+}
+
+void TransformSystem::SetParent(int node, int parent) {
+    // parent must not be node or one of its descendants
+    Detach(node);
+    Attach(node, parent);
+    Reroot(node, parent >= 0 ? m_depths[parent] + 1 : 0);
+    MarkDirty(node);
+}
+
+void TransformSystem::Update() {
+    if (!m_queued) {
+        return;
+    }
+
+    // Marking children queues them one depth down, which may add a queue,
+    // so the queues are indexed afresh rather than held by reference
+    for (size_t depth = 0; depth < m_dirtyByDepth.size(); ++depth) {
+        for (size_t i = 0; i < m_dirtyByDepth[depth].size(); ++i) {
+            int node = m_dirtyByDepth[depth][i];
+            if (!m_dirty[node] || m_depths[node] != (int)depth) {
+                continue;
+            }
+
+            m_dirty[node] = 0;
+            Recompute(node);
+            MarkChildrenDirty(node);
+        }
+        m_dirtyByDepth[depth].clear();
+    }
+
+    m_queued = 0;
+}
+
+void TransformSystem::UpdateReference() {
+    for (size_t node = 0; node < m_parents.size(); ++node) {
+        if (m_parents[node] < 0 && m_depths[node] >= 0) {
+            UpdateSubtree((int)node);
+        }
+    }
+
+    for (std::vector<int>& queue : m_dirtyByDepth) {
+        queue.clear();
+    }
+    std::fill(m_dirty.begin(), m_dirty.end(), 0);
+    m_queued = 0;
+}
+
+void TransformSystem::Recompute(int node) {
+    int parent = m_parents[node];
+    Transform local = GetLocal(node);
+    Transform world = local;
+    if (parent >= 0) {
+        Transform parentWorld = {m_worldX[parent], m_worldY[parent], m_worldScale[parent]};
+        world = parentWorld.Combine(local);
+    }
+
+    m_worldX[node] = world.X;
+    m_worldY[node] = world.Y;
+    m_worldScale[node] = world.Scale;
+}
+
+void TransformSystem::UpdateSubtree(int node) {
+    Recompute(node);
+    for (int child = m_firstChildren[node]; child >= 0; child = m_nextSiblings[child]) {
+        UpdateSubtree(child);
+    }
+}
+
+void TransformSystem::QueueAt(int node, int depth) {
+    if ((int)m_dirtyByDepth.size() <= depth) {
+        m_dirtyByDepth.resize(depth + 1);
+    }
+    m_dirtyByDepth[depth].push_back(node);
+    ++m_queued;
+}
+
+void TransformSystem::Attach(int node, int parent) {
+    m_parents[node] = parent;
+    m_previousSiblings[node] = -1;
+    m_nextSiblings[node] = -1;
+
+    if (parent >= 0) {
+        int next = m_firstChildren[parent];
+        if (next >= 0) {
+            m_previousSiblings[next] = node;
+        } else {
+            m_parentSlots[parent] = (int)m_parentNodes.size();
+            m_parentNodes.push_back(parent);
+        }
+        m_nextSiblings[node] = next;
+        m_firstChildren[parent] = node;
+    }
+}
+
+void TransformSystem::Detach(int node) {
+    int parent = m_parents[node];
+    int previous = m_previousSiblings[node];
+    int next = m_nextSiblings[node];
+
+    if (previous >= 0) {
+        m_nextSiblings[previous] = next;
+    } else if (parent >= 0) {
+        m_firstChildren[parent] = next;
+    }
+    if (next >= 0) {
+        m_previousSiblings[next] = previous;
+    }
+
+    // The parent's last child went; swap it out of the parent list
+    if (parent >= 0 && m_firstChildren[parent] < 0) {
+        int slot = m_parentSlots[parent];
+        int last = m_parentNodes.back();
+        m_parentNodes[slot] = last;
+        m_parentSlots[last] = slot;
+        m_parentNodes.pop_back();
+        m_parentSlots[parent] = -1;
+    }
+
+    m_parents[node] = -1;
+    m_previousSiblings[node] = -1;
+    m_nextSiblings[node] = -1;
+}
+
+void TransformSystem::Reroot(int node, int depth) {
+    m_depths[node] = depth;
+    m_dirty[node] = 0;
+    for (int child = m_firstChildren[node]; child >= 0; child = m_nextSiblings[child]) {
+        Reroot(child, depth + 1);
+    }
+}
@@ -1,123 +1,127 @@
 #include "../Include/Warrior.h"
-#include "../Include/Renderer.h"
-
-ObjectPool<Warrior>* Warrior::Pool = nullptr;
+#include "../Include/RenderQueue.h"
+#include "../Include/World.h"
 
 Warrior::Warrior() 
-    : m_x(0), m_y(0), m_speed(0), m_scale(1.0f),
-      m_animSpeed(0), m_animTimer(0), m_currentFrame(0),
-      m_state(State::RUNNING), m_runTexture(nullptr), m_deathTexture(nullptr) {
+    : m_speed(0), m_scale(1.0f), m_animSpeed(0), m_state(State::RUNNING),
+      m_animationSystem(nullptr), m_motionSystem(nullptr), m_transformSystem(nullptr),
+      m_animation(-1), m_motion(-1), m_transform(-1), m_runClip(-1), m_deathClip(-1) {
 }
 
 Warrior::~Warrior() {
-    // Textures are managed by pool
+    if (m_animation >= 0) {
+        m_animationSystem->ReleaseInstance(m_animation);
+        m_motionSystem->ReleaseInstance(m_motion);
+        m_transformSystem->ReleaseNode(m_transform);
+    }
+}
+
+void Warrior::BindWorld() {
+    if (m_animation < 0) {
+        World* world = World::GetCurrent();
+        m_animationSystem = world->GetAnimation();
+        m_transformSystem = world->GetTransforms();
+        m_transform = m_transformSystem->CreateNode(world->GetRoot());
+        m_motionSystem = world->GetMotion();
+        m_motion = m_motionSystem->CreateInstance(m_transform);
+
+        AnimationSystem* animation = m_animationSystem;
+        m_animation = animation->CreateInstance(this);
+        m_runClip = animation->FindClip(RUN_CLIP);
+        m_deathClip = animation->FindClip(DEATH_CLIP);
+    }
 }
 
 void Warrior::Initialize(float x, float y, float speed, float animSpeed, float scale) {
-    m_x = x;
-    m_y = y;
     m_speed = speed;
     m_animSpeed = animSpeed;
     m_scale = scale;
-    m_animTimer = 0.0f;
-    m_currentFrame = 0;
     m_state = State::RUNNING;
 
-    // Load textures
-    if (!m_runTexture) {
-        m_runTexture = Texture::Pool->GetResource();
-        m_runTexture->Load("Assets/Textures/warrior_run.tga");
-    }
-
-    if (!m_deathTexture) {
-        m_deathTexture = Texture::Pool->GetResource();
-        m_deathTexture->Load("Assets/Textures/warrior_death.tga");
-    }
-}
-
-void Warrior::Update(float deltaTime) {
-    if (m_state == State::DEAD) {
-        return;
-    }
-
-    // Move warrior
-    if (m_state == State::RUNNING) {
-        m_x += m_speed * deltaTime;
-    }
-
-    // Update animation
-    m_animTimer += deltaTime * m_animSpeed;
-
-    if (m_animTimer >= 1.0f) {
-        m_animTimer -= 1.0f;
-
-        if (m_state == State::RUNNING) {
-            m_currentFrame = (m_currentFrame + 1) % RUN_FRAMES;
-        } else if (m_state == State::DYING) {
-            m_currentFrame++;
-            if (m_currentFrame >= DEATH_FRAMES) {
-                m_state = State::DEAD;
-            }
-        }
-    }
+    BindWorld();
+    m_transformSystem->SetLocalScale(m_transform, m_scale);
+    m_motionSystem->SetPosition(m_motion, x, y);
+    m_motionSystem->SetVelocity(m_motion, m_speed, 0.0f);
+    m_motionSystem->SetMoving(m_motion, true);
+    m_animationSystem->Play(m_animation, m_runClip, m_animSpeed);
 }
 
-void Warrior::Render(Renderer* renderer) {
+void Warrior::Render(FramePacket* packet) {
     if (m_state == State::DEAD) {
         return;
     }
 
-    Texture* currentTexture = (m_state == State::RUNNING) ? m_runTexture : m_deathTexture;
-    int totalFrames = (m_state == State::RUNNING) ? RUN_FRAMES : DEATH_FRAMES;
+    AnimationSystem* animation = m_animationSystem;
+    Texture* texture = animation->GetTexture(m_animation);
 
-    if (currentTexture) {
-        renderer->RenderAnimatedTexture(currentTexture, m_currentFrame, totalFrames,
-                                        m_x, m_y, m_scale);
+    if (texture) {
+        Transform world = m_transformSystem->GetWorld(m_transform);
+        packet->RenderAnimatedTexture(texture, animation->GetSourceRect(m_animation),
+                                      world.X, world.Y, world.Scale);
     }
 }
 
 void Warrior::StartDeathAnimation() {
     if (m_state == State::RUNNING) {
         m_state = State::DYING;
-        m_currentFrame = 0;
-        m_animTimer = 0.0f;
+        m_motionSystem->SetMoving(m_motion, false);
+        m_animationSystem->Play(m_animation, m_deathClip, m_animSpeed);
+    }
+}
+
+void Warrior::OnAnimationEnd(int /*clipId*/, const std::string& event) {
+    if (event == "dead") {
+        m_state = State::DEAD;
     }
 }
 
 void Warrior::Serialize(std::ostream& stream) {
-    stream.write(reinterpret_cast<const char*>(&m_x), sizeof(float));
-    stream.write(reinterpret_cast<const char*>(&m_y), sizeof(float));
+    AnimationSystem* animation = m_animationSystem;
+    float animTimer = animation->GetTimer(m_animation);
+    int currentFrame = animation->GetFrame(m_animation);
+    float x = m_motionSystem->GetX(m_motion);
+    float y = m_motionSystem->GetY(m_motion);
+
+    stream.write(reinterpret_cast<const char*>(&x), sizeof(float));
+    stream.write(reinterpret_cast<const char*>(&y), sizeof(float));
     stream.write(reinterpret_cast<const char*>(&m_speed), sizeof(float));
     stream.write(reinterpret_cast<const char*>(&m_scale), sizeof(float));
     stream.write(reinterpret_cast<const char*>(&m_animSpeed), sizeof(float));
-    stream.write(reinterpret_cast<const char*>(&m_animTimer), sizeof(float));
-    stream.write(reinterpret_cast<const char*>(&m_currentFrame), sizeof(int));
+    stream.write(reinterpret_cast<const char*>(&animTimer), sizeof(float));
+    stream.write(reinterpret_cast<const char*>(&currentFrame), sizeof(int));
 
     int stateInt = static_cast<int>(m_state);
     stream.write(reinterpret_cast<const char*>(&stateInt), sizeof(int));
 }
 
 void Warrior::Deserialize(std::istream& stream) {
-    stream.read(reinterpret_cast<char*>(&m_x), sizeof(float));
-    stream.read(reinterpret_cast<char*>(&m_y), sizeof(float));
+    float x, y;
+    float animTimer;
+    int currentFrame;
+
+    stream.read(reinterpret_cast<char*>(&x), sizeof(float));
+    stream.read(reinterpret_cast<char*>(&y), sizeof(float));
     stream.read(reinterpret_cast<char*>(&m_speed), sizeof(float));
     stream.read(reinterpret_cast<char*>(&m_scale), sizeof(float));
     stream.read(reinterpret_cast<char*>(&m_animSpeed), sizeof(float));
-    stream.read(reinterpret_cast<char*>(&m_animTimer), sizeof(float));
-    stream.read(reinterpret_cast<char*>(&m_currentFrame), sizeof(int));
+    stream.read(reinterpret_cast<char*>(&animTimer), sizeof(float));
+    stream.read(reinterpret_cast<char*>(&currentFrame), sizeof(int));
 
     int stateInt;
     stream.read(reinterpret_cast<char*>(&stateInt), sizeof(int));
     m_state = static_cast<State>(stateInt);
 
-    // Reload textures
-    if (!m_runTexture) {
-        m_runTexture = Texture::Pool->GetResource();
-        m_runTexture->Load("Assets/Textures/warrior_run.tga");
-    }
+    // Restore position and animation playback
+    BindWorld();
+    m_transformSystem->SetLocalScale(m_transform, m_scale);
+    m_motionSystem->SetPosition(m_motion, x, y);
+    m_motionSystem->SetVelocity(m_motion, m_speed, 0.0f);
+    m_motionSystem->SetMoving(m_motion, m_state == State::RUNNING);
 
-    if (!m_deathTexture) {
-        m_deathTexture = Texture::Pool->GetResource();
-        m_deathTexture->Load("Assets/Textures/warrior_death.tga");
+    AnimationSystem* animation = m_animationSystem;
+    animation->Play(m_animation, (m_state == State::RUNNING) ? m_runClip : m_deathClip, m_animSpeed);
+    animation->SetState(m_animation, currentFrame, animTimer);
+    if (m_state == State::DEAD) {
+        animation->Stop(m_animation);
     }
 }
@@ -0,0 +1,78 @@
+#include "../Include/WorkerPool.h"
+
+WorkerPool::WorkerPool(unsigned int threadCount)
+    : m_job(nullptr), m_count(0), m_next(0), m_active(0), m_generation(0), m_stopping(false) {
+    if (threadCount == 0) {
+        unsigned int cores = std::thread::hardware_concurrency();
+        threadCount = cores > 1 ? cores - 1 : 0;
+    }
+
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back(&WorkerPool::WorkerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::ParallelFor(size_t count, const std::function<void(size_t)>& job) {
+    if (m_threads.empty() || count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            job(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_count = count;
+        m_next.store(0, std::memory_order_relaxed);
+        m_active = m_threads.size();
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    RunJobs();
+
+    // Every worker checks in once per generation, even if it found no work
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return m_active == 0; });
+    m_job = nullptr;
+}
+
+void WorkerPool::RunJobs() {
+    for (size_t i = m_next.fetch_add(1); i < m_count; i = m_next.fetch_add(1)) {
+        (*m_job)(i);
+    }
+}
+
+void WorkerPool::WorkerLoop() {
+    unsigned long long seen = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (;;) {
+        m_wake.wait(lock, [&]() { return m_stopping || m_generation != seen; });
+        if (m_stopping) {
+            return;
+        }
+        seen = m_generation;
+
+        lock.unlock();
+        RunJobs();
+        lock.lock();
+
+        if (--m_active == 0) {
+            m_done.notify_one();
+        }
+    }
+}
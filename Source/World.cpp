@@ -0,0 +1,26 @@
+#include "../Include/World.h"
+
+World* World::s_default = nullptr;
+thread_local World* World::t_current = nullptr;
+
+World::World(size_t warriors, size_t rocks, unsigned int seed, AnimationSystem* animation)
+    : m_animation(animation), m_root(m_transforms.CreateNode()), m_motion(&m_transforms, m_root),
+      m_warriorPool(warriors, "Warrior"), m_rockPool(rocks, "Rock"),
+      m_seed(seed), m_autoSave(true) {
+    // One node per pooled entity plus the root, sized up front so
+    // entities binding as they spawn don't grow the storage mid-frame
+    m_transforms.Reserve(warriors + rocks + 1);
+    m_motion.Reserve(warriors + rocks + 1);
+
+    if (!m_animation) {
+        m_ownedAnimation.reset(new AnimationSystem());
+        m_ownedAnimation->ShareClips(*AnimationSystem::GetInstance());
+        m_animation = m_ownedAnimation.get();
+    }
+}
+
+World::~World() {
+    if (s_default == this) {
+        s_default = nullptr;
+    }
+}
@@ -1,9 +1,212 @@
 #include "../Include/GameController.h"
+#include "../Include/SimulationFarm.h"
+#include "../Include/Log.h"
+#include "../Include/Metrics.h"
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+    // Parses the value of a --name=value flag. Logs and returns false unless
+    // the whole value is a number in [min, max], so a typo or a negative
+    // count is rejected here instead of throwing or wrapping around later.
+    template <typename T>
+    bool ParseFlag(const std::string& arg, T min, T max, T& value) {
+        using Wide = typename std::conditional<std::is_integral<T>::value, long long, double>::type;
+        size_t equals = arg.find('=');
+        std::string text = arg.substr(equals + 1);
+        try {
+            size_t used = 0;
+            Wide parsed;
+            if constexpr (std::is_integral<T>::value) {
+                parsed = std::stoll(text, &used);
+            } else {
+                parsed = std::stod(text, &used);
+            }
+            if (used == text.size() && parsed >= (Wide)min && parsed <= (Wide)max) {
+                value = (T)parsed;
+                return true;
+            }
+        } catch (const std::exception&) {
+        }
+
+        LOG_ERROR("Invalid value for %s: %s", arg.substr(0, equals).c_str(), text.c_str());
+        return false;
+    }
+}
 
 int main(int argc, char* argv[]) {
     GameController* game = GameController::GetInstance();
+
+    const size_t MB = 1024 * 1024;
+    size_t cpuBudget = 64 * MB;
+    size_t textureBudget = 64 * MB;
+    const size_t MAX_BUDGET_MB = std::numeric_limits<size_t>::max() / MB;   // So megabytes * MB can't wrap
+    const float MAX_RATE = 100000.0f;
+    const unsigned int MAX_THREADS = 1024;
+    const int MAX_FARM_WORLDS = 1000000;
+
+    StressConfig stressConfig;
+    bool stressTest = false;
+    FarmConfig farmConfig;
+    bool farm = false;
+    std::string perfReport, perfBaseline, logFile, metricsTarget;
+    int metricsIntervalMs = 1000;
+    double perfTolerance = 0.25;
+    bool perfTiming = false;
+    const std::string stressPrefix = "--stress-";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dirty-rects") {
+            game->SetDamageTracking(true);
+        } else if (arg == "--software-raster") {
+            game->SetSoftwareRaster(true);
+        } else if (arg == "--headless") {
+            game->SetHeadless(true);
+        } else if (arg.rfind("--raster-threads=", 0) == 0) {
+            unsigned int threads;
+            if (!ParseFlag(arg, 0u, MAX_THREADS, threads)) {
+                return 1;
+            }
+            game->SetRasterThreads(threads);
+        } else if (arg.rfind("--capture=", 0) == 0) {
+            game->SetCapture(arg.substr(10), FrameCapture::Format::TGA);
+        } else if (arg.rfind("--capture-raw=", 0) == 0) {
+            game->SetCapture(arg.substr(14), FrameCapture::Format::RAW);
+        } else if (arg == "--memory-stats") {
+            game->SetMemoryStats(true);
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            if (!ParseFlag(arg, 0u, std::numeric_limits<unsigned int>::max(), farmConfig.Seed)) {
+                return 1;
+            }
+            game->SetRandomSeed(farmConfig.Seed);
+        } else if (arg.rfind("--frame-rate=", 0) == 0) {
+            float hz;
+            if (!ParseFlag(arg, 0.0f, MAX_RATE, hz)) {
+                return 1;
+            }
+            game->SetFrameRateLimit(hz);
+        } else if (arg.rfind("--fixed-frame-rate=", 0) == 0) {
+            float hz;
+            if (!ParseFlag(arg, 0.0f, MAX_RATE, hz)) {
+                return 1;
+            }
+            game->SetFixedFrameRate(hz);
+        } else if (arg.rfind("--perf-report=", 0) == 0) {
+            perfReport = arg.substr(14);
+        } else if (arg.rfind("--perf-baseline=", 0) == 0) {
+            perfBaseline = arg.substr(16);
+        } else if (arg.rfind("--perf-tolerance=", 0) == 0) {
+            if (!ParseFlag(arg, 0.0, 100.0, perfTolerance)) {
+                return 1;
+            }
+        } else if (arg == "--perf-timing") {
+            perfTiming = true;
+        } else if (arg.rfind("--log-file=", 0) == 0) {
+            logFile = arg.substr(11);
+        } else if (arg.rfind("--log-level=", 0) == 0) {
+            LogLevel level;
+            if (!Log::ParseLevel(arg.substr(12), level)) {
+                LOG_ERROR("Unknown log level: %s", arg.substr(12).c_str());
+                return 1;
+            }
+            Log::SetLevel(level);
+        } else if (arg.rfind("--metrics=", 0) == 0) {
+            metricsTarget = arg.substr(10);
+        } else if (arg.rfind("--metrics-interval-ms=", 0) == 0) {
+            if (!ParseFlag(arg, 1, 3600 * 1000, metricsIntervalMs)) {
+                return 1;
+            }
+        } else if (arg == "--hot-reload") {
+            game->SetHotReload(true);
+        } else if (arg == "--no-pipelining") {
+            game->SetPipelining(false);
+        } else if (arg.rfind("--sim-hz=", 0) == 0) {
+            if (!ParseFlag(arg, 0.0f, MAX_RATE, farmConfig.StepRate)) {
+                return 1;
+            }
+            game->SetSimulationRate(farmConfig.StepRate);
+        } else if (arg.rfind("--cpu-budget-mb=", 0) == 0) {
+            size_t megabytes;
+            if (!ParseFlag(arg, (size_t)0, MAX_BUDGET_MB, megabytes)) {
+                return 1;
+            }
+            cpuBudget = megabytes * MB;
+        } else if (arg.rfind("--texture-budget-mb=", 0) == 0) {
+            size_t megabytes;
+            if (!ParseFlag(arg, (size_t)0, MAX_BUDGET_MB, megabytes)) {
+                return 1;
+            }
+            textureBudget = megabytes * MB;
+        } else if (arg.rfind("--farm=", 0) == 0) {
+            farm = true;
+            if (!ParseFlag(arg, 1, MAX_FARM_WORLDS, farmConfig.Worlds)) {
+                return 1;
+            }
+        } else if (arg.rfind("--farm-threads=", 0) == 0) {
+            if (!ParseFlag(arg, 1u, MAX_THREADS, farmConfig.Threads)) {
+                return 1;
+            }
+        } else if (arg == "--stress") {
+            stressTest = true;
+        } else if (arg.rfind("--stress=", 0) == 0) {
+            stressTest = true;
+            if (!stressConfig.LoadFromFile(arg.substr(9))) {
+                return 1;
+            }
+        } else if (arg.rfind(stressPrefix, 0) == 0) {
+            // --stress-<key>=<value> overrides a single setting
+            size_t equals = arg.find('=');
+            std::string key = arg.substr(stressPrefix.size(), equals - stressPrefix.size());
+            std::string value = (equals == std::string::npos) ? "" : arg.substr(equals + 1);
+            stressTest = true;
+            if (!stressConfig.Set(key, value)) {
+                return 1;
+            }
+        }
+    }
+
+    // 0 means step once per frame, which a farm has no frames for
+    if (farm && farmConfig.StepRate <= 0.0f) {
+        LOG_ERROR("--sim-hz must be positive with --farm");
+        return 1;
+    }
+
+    if (!Log::Start(logFile)) {
+        return 1;
+    }
+
+    MetricsExporter metricsExporter;
+    if (!metricsTarget.empty() && !metricsExporter.Start(metricsTarget, metricsIntervalMs)) {
+        Log::Stop();
+        return 1;
+    }
+
+    if (farm) {
+        // Batch run instead of the game: no window, many worlds at once
+        GameController::DestroyInstance();
+        SimulationFarm simulationFarm(farmConfig);
+        bool ran = simulationFarm.Run();
+        Log::Flush();
+        simulationFarm.PrintSummary(std::cout);
+        metricsExporter.Stop();
+        Log::Stop();
+        return ran ? 0 : 1;
+    }
+
+    game->SetResidencyBudgets(cpuBudget, textureBudget);
+    game->SetPerfReport(perfReport, perfBaseline, perfTolerance, perfTiming);
+
+    if (stressTest) {
+        game->EnableStressTest(stressConfig);
+    }
+
     game->RunGame();
+    int exitCode = game->GetExitCode();
     GameController::DestroyInstance();
+    metricsExporter.Stop();
+    Log::Stop();
 
-    return 0;
+    return exitCode;
 }
@@ -0,0 +1,62 @@
+#include "../Include/CookedTexture.h"
+#include "../Include/FileController.h"
+#include "../Include/TGAReader.h"
+#include <filesystem>
+
+// Usage: asset_cook <asset directory> <output directory>
+//
+// Converts every .tga under the asset directory into a .ctex at the same
+// relative path under the output directory, which is normally the Assets/
+// copy next to the game.
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: asset_cook <asset directory> <output directory>" << std::endl;
+        return 1;
+    }
+
+    namespace fs = std::filesystem;
+    fs::path root = fs::path(argv[1]).lexically_normal();
+    fs::path output = fs::path(argv[2]).lexically_normal();
+
+    std::error_code error;
+    std::vector<fs::path> sources;
+    for (auto& item : fs::recursive_directory_iterator(root, error)) {
+        std::string extension = item.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (item.is_regular_file() && extension == ".tga") {
+            sources.push_back(item.path());
+        }
+    }
+    if (error) {
+        std::cerr << "Failed to scan " << argv[1] << ": " << error.message() << std::endl;
+        return 1;
+    }
+
+    bool ok = true;
+    size_t cookedBytes = 0;
+    std::vector<unsigned char> cooked;
+    for (const fs::path& source : sources) {
+        fs::path target = output / fs::path(CookedTexture::GetCookedPath(source.lexically_relative(root).generic_string()));
+
+        ImageInfo* image = TGAReader::ReadTGA(source.string());
+        bool written = image && CookedTexture::Cook(*image, cooked);
+        if (image) {
+            delete[] image->Data;
+            delete image;
+        }
+
+        fs::create_directories(target.parent_path(), error);
+        written = written && FileController::GetInstance()->WriteFile(target.string(), cooked.data(), cooked.size());
+        if (!written) {
+            std::cerr << "Failed to cook " << source.generic_string() << std::endl;
+            ok = false;
+            continue;
+        }
+        cookedBytes += cooked.size();
+    }
+
+    std::cout << "Cooked " << sources.size() << " textures (" << cookedBytes / 1024 << " KB) into "
+              << output.generic_string() << std::endl;
+    FileController::DestroyInstance();
+    return ok ? 0 : 1;
+}
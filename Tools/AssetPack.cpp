@@ -0,0 +1,12 @@
+#include "../Include/AssetArchive.h"
+#include <iostream>
+
+// Usage: asset_pack <asset directory> <output .pak>
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: asset_pack <asset directory> <output .pak>" << std::endl;
+        return 1;
+    }
+
+    return AssetArchive::Pack(argv[1], argv[2]) ? 0 : 1;
+}
@@ -0,0 +1,923 @@
+#include "../Include/AnimationSystem.h"
+#include "../Include/AssetController.h"
+#include "../Include/CpuFeatures.h"
+#include "../Include/EventScheduler.h"
+#include "../Include/FileController.h"
+#include "../Include/Level2.h"
+#include "../Include/MemoryTracker.h"
+#include "../Include/MotionSystem.h"
+#include "../Include/Renderer.h"
+#include "../Include/SoftwareRasterizer.h"
+#include "../Include/ResidencyManager.h"
+#include "../Include/StackAllocator.h"
+#include "../Include/Task.h"
+#include "../Include/TGAReader.h"
+#include "../Include/TransformSystem.h"
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <thread>
+
+// Usage: SDLLevels_bench [--out=<file.json>] [--filter=<text>] [--min-time-ms=<N>]
+//
+// Microbenchmarks for the engine's hot paths. Each case runs in samples of
+// at least --min-time-ms and reports median/min/max nanoseconds and heap
+// allocations per operation. SDL uses the dummy video driver unless
+// SDL_VIDEO_DRIVER says otherwise, so no display is needed.
+
+namespace {
+
+struct BenchResult {
+    std::string Name;
+    size_t N;
+    size_t Operations;      // Per sample
+    double MedianNs;
+    double MinNs;
+    double MaxNs;
+    double AllocationsPerOp;
+};
+
+// Keeps results alive so the optimizer can't drop the work producing them
+volatile uintptr_t g_sink;
+
+void Consume(const void* value) {
+    g_sink = (uintptr_t)value;
+}
+
+bool SameBits(float a, float b) {
+    return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+size_t CountAllocations() {
+    size_t count = 0;
+    for (size_t i = 0; i < (size_t)MemoryTag::COUNT; ++i) {
+        count += MemoryTracker::GetStats((MemoryTag)i).FrameAllocations;
+    }
+    return count;
+}
+
+class BenchRunner {
+public:
+    static const int SAMPLES = 9;
+
+    BenchRunner(const std::string& filter, double minTimeMs) : m_filter(filter), m_minTimeMs(minTimeMs) {}
+
+    // body(iterations) runs the case that many times; each iteration is
+    // opsPerIteration operations
+    void Run(const std::string& name, size_t n, size_t opsPerIteration,
+             const std::function<void(size_t)>& body) {
+        if (!m_filter.empty() && name.find(m_filter) == std::string::npos) {
+            return;
+        }
+
+        // Grow the sample until it's long enough to time reliably
+        size_t iterations = 1;
+        while (TimeMs(body, iterations) < m_minTimeMs && iterations < ((size_t)1 << 40)) {
+            iterations *= 2;
+        }
+
+        std::vector<double> samples;
+        MemoryTracker::EndFrame();
+        for (int i = 0; i < SAMPLES; ++i) {
+            samples.push_back(TimeMs(body, iterations) * 1e6 / (double)(iterations * opsPerIteration));
+        }
+        MemoryTracker::EndFrame();
+        std::sort(samples.begin(), samples.end());
+
+        BenchResult result;
+        result.Name = name;
+        result.N = n;
+        result.Operations = iterations * opsPerIteration;
+        result.MedianNs = samples[SAMPLES / 2];
+        result.MinNs = samples.front();
+        result.MaxNs = samples.back();
+        result.AllocationsPerOp = CountAllocations() / (double)(SAMPLES * result.Operations);
+        m_results.push_back(result);
+
+        std::cout << std::left << std::setw(44) << name << std::right << std::setw(8) << n
+                  << std::fixed << std::setprecision(1) << std::setw(14) << result.MedianNs
+                  << std::setw(14) << result.MinNs << std::setprecision(2)
+                  << std::setw(12) << result.AllocationsPerOp << std::endl;
+    }
+
+    static void PrintHeader() {
+        std::cout << std::left << std::setw(44) << "Benchmark" << std::right << std::setw(8) << "N"
+                  << std::setw(14) << "ns/op" << std::setw(14) << "min ns/op"
+                  << std::setw(12) << "allocs/op" << std::endl;
+    }
+
+    bool WriteJson(const std::string& path) const {
+        std::ostringstream json;
+        json << "{\n  \"context\": {\n";
+        json << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+        json << "    \"build\": \"release\",\n";
+#else
+        json << "    \"build\": \"debug\",\n";
+#endif
+        json << "    \"samples\": " << SAMPLES << "\n  },\n  \"benchmarks\": [\n";
+
+        for (size_t i = 0; i < m_results.size(); ++i) {
+            const BenchResult& r = m_results[i];
+            json << "    {\"name\": \"" << r.Name << "\", \"n\": " << r.N
+                 << ", \"operations\": " << r.Operations << std::setprecision(6)
+                 << ", \"ns_per_op\": " << r.MedianNs << ", \"min_ns_per_op\": " << r.MinNs
+                 << ", \"max_ns_per_op\": " << r.MaxNs
+                 << ", \"allocs_per_op\": " << r.AllocationsPerOp << "}"
+                 << (i + 1 < m_results.size() ? "," : "") << "\n";
+        }
+        json << "  ]\n}\n";
+
+        std::string text = json.str();
+        if (!FileController::GetInstance()->WriteFile(path, text.data(), text.size())) {
+            return false;
+        }
+        std::cout << "Wrote " << m_results.size() << " results to " << path << std::endl;
+        return true;
+    }
+
+private:
+    static double TimeMs(const std::function<void(size_t)>& body, size_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        body(iterations);
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    std::string m_filter;
+    double m_minTimeMs;
+    std::vector<BenchResult> m_results;
+};
+
+} // namespace
+
+// Friend of Level2, so collision checks can run on a hand-built population
+class LevelBench {
+public:
+    static void Populate(Level2& level, size_t warriors, size_t rocks, std::mt19937& gen) {
+        std::uniform_real_distribution<float> x(0.0f, 1856.0f);
+        std::uniform_real_distribution<float> y(0.0f, 1016.0f);
+        std::uniform_real_distribution<float> speed(80.0f, 100.0f);
+
+        for (size_t i = 0; i < warriors; ++i) {
+            Warrior* warrior = level.GetWorld()->GetWarriorPool()->GetResource();
+            warrior->Initialize(x(gen), y(gen), speed(gen), 1.0f, 1.0f);
+            level.m_warriors.push_back(warrior);
+        }
+        for (size_t i = 0; i < rocks; ++i) {
+            Rock* rock = level.GetWorld()->GetRockPool()->GetResource();
+            rock->Initialize(x(gen), y(gen), speed(gen), 1.0f, 1.0f);
+            level.m_rocks.push_back(rock);
+        }
+        level.GetWorld()->GetTransforms()->Update();
+    }
+
+    static void CheckCollisions(Level2& level, float deltaTime) {
+        level.CheckCollisions(deltaTime);
+    }
+};
+
+static void BenchTGA(BenchRunner& bench) {
+    const char* path = "Assets/Textures/warrior_run.tga";
+    int width, height, bpp;
+    if (!TGAReader::ReadTGAHeader(path, width, height, bpp)) {
+        return;
+    }
+
+    bench.Run("TGAReader::ReadTGA", (size_t)width * height, 1, [&](size_t iterations) {
+        for (size_t i = 0; i < iterations; ++i) {
+            ImageInfo* info = TGAReader::ReadTGA(path);
+            Consume(info);
+            delete[] info->Data;
+            delete info;
+        }
+    });
+}
+
+static void BenchObjectPool(BenchRunner& bench) {
+    for (size_t n : {16, 1024}) {
+        ObjectPool<Warrior> pool(n, "Bench");
+        std::vector<Warrior*> taken(n);
+        bench.Run("ObjectPool::GetResource+ReturnResource", n, n, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                for (size_t k = 0; k < n; ++k) taken[k] = pool.GetResource();
+                for (size_t k = 0; k < n; ++k) pool.ReturnResource(taken[k]);
+            }
+        });
+    }
+}
+
+static void BenchStackAllocator(BenchRunner& bench) {
+    for (size_t size : {16, 4096}) {
+        StackAllocator allocator(1024 * 1024);
+        bench.Run("StackAllocator::Allocate", size, 1, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                void* memory = allocator.Allocate(size);
+                if (!memory) {
+                    allocator.Clear();
+                    memory = allocator.Allocate(size);
+                }
+                Consume(memory);
+            }
+        });
+    }
+}
+
+static void BenchLevels(BenchRunner& bench) {
+    std::mt19937 gen(1234);
+
+    for (size_t n : {10, 1000}) {
+        Level2 level;
+        LevelBench::Populate(level, n, n, gen);
+        level.GetWorld()->GetWarriorPool()->Reserve(n);
+        level.GetWorld()->GetRockPool()->Reserve(n);
+
+        bench.Run("Level2::Serialize+Deserialize", n, 1, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                std::stringstream stream;
+                level.Serialize(stream);
+                Level2 copy;
+                copy.Deserialize(stream);
+                Consume(&copy);
+            }
+        });
+    }
+
+    for (size_t n : {10, 100, 1000}) {
+        Level2 level;
+        LevelBench::Populate(level, n, n, gen);
+
+        // Contacts kill warriors and stop rocks, so later samples measure a
+        // settled scene; the pair tests dominate either way
+        bench.Run("Level2::CheckCollisions", n, 1, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                LevelBench::CheckCollisions(level, 1.0f / 60.0f);
+            }
+        });
+    }
+}
+
+// EventScheduler's ordering done the plain way: every pending event in one
+// map sorted by time, then by scheduling order
+class SortedScheduler {
+public:
+    SortedScheduler() : m_time(0.0), m_nextSequence(0) {}
+
+    uint64_t At(double time, std::function<void()> callback) {
+        uint64_t sequence = m_nextSequence++;
+        m_pending[{time, sequence}] = std::move(callback);
+        m_times[sequence] = time;
+        return sequence;
+    }
+
+    bool Cancel(uint64_t sequence) {
+        auto found = m_times.find(sequence);
+        if (found == m_times.end()) {
+            return false;
+        }
+        m_pending.erase({found->second, sequence});
+        m_times.erase(found);
+        return true;
+    }
+
+    void AdvanceTo(double time) {
+        m_time = std::max(m_time, time);
+        while (!m_pending.empty() && m_pending.begin()->first.first <= m_time) {
+            auto first = m_pending.begin();
+            std::function<void()> callback = std::move(first->second);
+            m_times.erase(first->first.second);
+            m_pending.erase(first);
+            callback();
+        }
+    }
+
+    double GetTime() const { return m_time; }
+    size_t GetPendingCount() const { return m_pending.size(); }
+
+private:
+    double m_time;
+    uint64_t m_nextSequence;
+    std::map<std::pair<double, uint64_t>, std::function<void()>> m_pending;
+    std::map<uint64_t, double> m_times;
+};
+
+// Random schedules, cancels and advances, some past the clock, some far
+// enough ahead to overflow the wheel; both must fire the same events in
+// the same order
+static bool CheckScheduler(unsigned int seed) {
+    const int OPERATIONS = 4000;
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> action(0, 9);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    EventScheduler wheel;
+    SortedScheduler reference;
+    std::vector<std::pair<EventScheduler::EventId, uint64_t>> ids;
+    std::vector<int> wheelFired, referenceFired;
+
+    for (int i = 0; i < OPERATIONS; ++i) {
+        int choice = action(gen);
+        if (choice < 5) {
+            // Mostly soon, some a few minutes out, some past 2^24 ticks, some overdue
+            double ahead = unit(gen);
+            int kind = choice % 4;
+            double time = reference.GetTime() + (kind == 0 ? ahead : kind == 1 ? ahead * 300.0 :
+                                                 kind == 2 ? ahead * 40000.0 : -ahead);
+            if (kind == 0) {
+                // On a coarse grid, so events share times and fire by scheduling order
+                time = std::floor(time * 20.0) / 20.0;
+            }
+            ids.push_back({wheel.At(time, [&wheelFired, i] { wheelFired.push_back(i); }),
+                           reference.At(time, [&referenceFired, i] { referenceFired.push_back(i); })});
+        } else if (choice < 7 && !ids.empty()) {
+            size_t pick = std::uniform_int_distribution<size_t>(0, ids.size() - 1)(gen);
+            if (wheel.Cancel(ids[pick].first) != reference.Cancel(ids[pick].second)) {
+                std::cerr << "EventScheduler::Cancel differs from the reference (seed " << seed << ")" << std::endl;
+                return false;
+            }
+        } else {
+            // Small steps, with the odd jump across hours
+            double step = choice == 9 && unit(gen) < 0.1 ? unit(gen) * 20000.0 : unit(gen) * 0.5;
+            double time = reference.GetTime() + step;
+            wheel.AdvanceTo(time);
+            reference.AdvanceTo(time);
+        }
+
+        if (wheelFired != referenceFired || wheel.GetPendingCount() != reference.GetPendingCount()) {
+            std::cerr << "EventScheduler differs from the reference (seed " << seed << ", operation " << i << ")" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sleeps for each delay in turn, noting the time it wakes at
+static Task Sleeper(EventScheduler& scheduler, std::vector<double> delays, std::vector<double>& wakes) {
+    for (double delay : delays) {
+        co_await Seconds(delay);
+        wakes.push_back(scheduler.GetTime());
+    }
+}
+
+// Waits for value to reach target, noting target, or -target on a timeout
+static Task Waiter(TaskSignal& signal, const int& value, int target, double timeout, std::vector<int>& results) {
+    bool reached = co_await Condition(signal, [&value, target] { return value >= target; }, timeout);
+    results.push_back(reached ? target : -target);
+}
+
+// Tasks wake when their waits say and no sooner: sleeps at their times,
+// conditions only when notified with the predicate holding or at their
+// timeout, and a destroyed task not at all
+static bool CheckTasks() {
+    const double inf = std::numeric_limits<double>::infinity();
+    EventScheduler scheduler;
+    TaskSignal signal;
+    int value = 0;
+    std::vector<double> wakes;
+    std::vector<int> results;
+
+    Task sleeper = Sleeper(scheduler, {0.5, 0.25, 1.0}, wakes);
+    Task first = Waiter(signal, value, 1, inf, results);
+    Task second = Waiter(signal, value, 2, 1.0, results);
+    Task third = Waiter(signal, value, 3, inf, results);
+    for (Task* task : {&sleeper, &first, &second, &third}) {
+        task->Start(scheduler);
+    }
+    {
+        Task dropped = Sleeper(scheduler, {0.25}, wakes);
+        dropped.Start(scheduler);
+    }
+
+    // Steps of 0.25 s; value changes unannounced at 0.25 and is notified at
+    // 0.5, then reaches 3 with a notify at 1.25, after second's timeout
+    std::vector<std::vector<int>> expected = {{}, {}, {1}, {1}, {1, -2}, {1, -2, 3}};
+    for (int step = 1; step <= 8; ++step) {
+        scheduler.AdvanceTo(step * 0.25);
+        if (step == 1) {
+            value = 1;
+        } else if (step == 2) {
+            signal.Notify();
+        } else if (step == 5) {
+            value = 3;
+            signal.Notify();
+        }
+
+        if (results != expected[std::min(step, 5)]) {
+            std::cerr << "Task conditions resumed out of turn at " << step * 0.25 << " s" << std::endl;
+            return false;
+        }
+    }
+
+    if (wakes != std::vector<double>{0.5, 0.75, 1.75} || !sleeper.IsDone() || !third.IsDone() ||
+        scheduler.GetPendingCount() != 0) {
+        std::cerr << "Task sleeps woke at the wrong times" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Sleeps for random delays up to horizon, forever, counting its wakes
+static Task Wanderer(std::mt19937& gen, double horizon, size_t& wakes) {
+    std::uniform_real_distribution<double> ahead(0.0, horizon);
+    for (;;) {
+        co_await Seconds(ahead(gen));
+        ++wakes;
+    }
+}
+
+// Checked over a range of seeds, then timed with n events kept pending:
+// each operation schedules one event somewhere in the next n steps and
+// advances one step, which fires about one. Tasks are timed the same way,
+// n of them each sleeping up to n steps at a time.
+static bool BenchScheduler(BenchRunner& bench) {
+    bool matched = CheckTasks();
+    for (unsigned int seed = 1; seed <= 50 && matched; ++seed) {
+        matched = CheckScheduler(seed);
+    }
+
+    const double step = 1.0 / 1000.0;
+    for (size_t n : {1000, 100000, 1000000}) {
+        std::mt19937 gen(1234);
+        std::uniform_real_distribution<double> ahead(0.0, n * step);
+        size_t fired = 0;
+        auto count = [&fired] { ++fired; };
+
+        EventScheduler wheel;
+        SortedScheduler reference;
+        for (size_t i = 0; i < n; ++i) {
+            double time = ahead(gen);
+            wheel.At(time, count);
+            reference.At(time, count);
+        }
+
+        bench.Run("EventScheduler::At+AdvanceTo", n, 1, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                wheel.At(wheel.GetTime() + ahead(gen), count);
+                wheel.AdvanceTo(wheel.GetTime() + step);
+            }
+        });
+        bench.Run("SortedScheduler::At+AdvanceTo", n, 1, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                reference.At(reference.GetTime() + ahead(gen), count);
+                reference.AdvanceTo(reference.GetTime() + step);
+            }
+        });
+        Consume(&fired);
+    }
+
+    for (size_t n : {1000, 100000}) {
+        std::mt19937 gen(1234);
+        size_t wakes = 0;
+        EventScheduler scheduler;
+        std::vector<Task> tasks(n);
+        for (Task& task : tasks) {
+            task = Wanderer(gen, n * step, wakes);
+            task.Start(scheduler);
+        }
+
+        bench.Run("Task co_await Seconds", n, 1, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                scheduler.AdvanceTo(scheduler.GetTime() + step);
+            }
+        });
+        Consume(&wakes);
+    }
+
+    return matched;
+}
+
+// Local and world transforms of the first count nodes match bit for bit
+static bool SameWorld(const TransformSystem& a, const TransformSystem& b, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        Transform localA = a.GetLocal((int)i), localB = b.GetLocal((int)i);
+        Transform worldA = a.GetWorld((int)i), worldB = b.GetWorld((int)i);
+        if (!SameBits(localA.X, localB.X) || !SameBits(localA.Y, localB.Y) ||
+            !SameBits(worldA.X, worldB.X) || !SameBits(worldA.Y, worldB.Y) ||
+            !SameBits(worldA.Scale, worldB.Scale)) {
+            std::cerr << "Transforms differ from the reference at node " << i << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Laid out as a World lays out its entities: count nodes under a root,
+// each driven by a motion instance, one in eight stopped
+static void PopulateMotion(TransformSystem& transforms, MotionSystem& motion, int root, size_t count,
+                           std::mt19937& gen) {
+    std::uniform_real_distribution<float> position(-100.0f, 1920.0f);
+    std::uniform_real_distribution<float> speed(80.0f, 100.0f);
+    transforms.Reserve(count + 1);
+    motion.Reserve(count + 1);
+    for (size_t i = 0; i < count; ++i) {
+        int node = transforms.CreateNode(root);
+        transforms.SetLocalScale(node, (i & 2) ? 1.8f : 1.0f);
+        int instance = motion.CreateInstance(node);
+        motion.SetPosition(instance, position(gen), position(gen));
+        motion.SetVelocity(instance, (i & 1) ? speed(gen) : 0.0f, (i & 1) ? 0.0f : speed(gen));
+        motion.SetMoving(instance, i % 8 != 0);
+    }
+    transforms.Update();
+}
+
+// Plays looping and one-shot clips at mixed rates, one in eight stopped
+static void PopulateAnimation(AnimationSystem& animation, size_t count, std::mt19937& gen) {
+    std::uniform_real_distribution<float> rate(4.8f, 6.0f);
+    int clips[] = {animation.FindClip(Rock::CLIP), animation.FindClip(Warrior::RUN_CLIP),
+                   animation.FindClip(Warrior::DEATH_CLIP)};
+    for (size_t i = 0; i < count; ++i) {
+        int instance = animation.CreateInstance(nullptr);
+        animation.Play(instance, clips[i % 3], rate(gen));
+        if (i % 8 == 0) {
+            animation.Stop(instance);
+        }
+    }
+}
+
+// Steps motion on a world of n entities alongside UpdateReference and
+// compares every node, bit for bit
+static bool CheckMotion(size_t n, int steps) {
+    const float step = 1.0f / 60.0f;
+    std::mt19937 gen(1234), referenceGen(1234);
+    TransformSystem transforms, referenceTransforms;
+    int root = transforms.CreateNode();
+    int referenceRoot = referenceTransforms.CreateNode();
+    MotionSystem motion(&transforms, root);
+    MotionSystem reference(&referenceTransforms, referenceRoot);
+    PopulateMotion(transforms, motion, root, n, gen);
+    PopulateMotion(referenceTransforms, reference, referenceRoot, n, referenceGen);
+
+    for (int i = 0; i < steps; ++i) {
+        // Pans and zooms the root now and then, through the queues
+        if (i % 100 == 50) {
+            transforms.SetLocal(root, {(float)i, -(float)i, 0.75f});
+            referenceTransforms.SetLocal(referenceRoot, {(float)i, -(float)i, 0.75f});
+        }
+        motion.Update(step);
+        transforms.Update();
+        reference.UpdateReference(step);
+        referenceTransforms.UpdateReference();
+    }
+    return SameWorld(transforms, referenceTransforms, transforms.GetNodeCount());
+}
+
+static bool CheckAnimation(size_t n, int steps) {
+    const float step = 1.0f / 60.0f;
+    std::mt19937 gen(1234), referenceGen(1234);
+    AnimationSystem animation, reference;
+    animation.ShareClips(*AnimationSystem::GetInstance());
+    reference.ShareClips(*AnimationSystem::GetInstance());
+    PopulateAnimation(animation, n, gen);
+    PopulateAnimation(reference, n, referenceGen);
+
+    for (int i = 0; i < steps; ++i) {
+        animation.Update(step);
+        reference.UpdateReference(step);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (animation.GetFrame((int)i) != reference.GetFrame((int)i) ||
+            !SameBits(animation.GetTimer((int)i), reference.GetTimer((int)i))) {
+            std::cerr << "AnimationSystem::Update differs from the reference at instance " << i << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Every instruction set this CPU runs, narrowest first
+static std::vector<SimdLevel> GetSimdLevels() {
+    std::vector<SimdLevel> levels;
+    for (int level = 0; level <= (int)CpuFeatures::GetSupportedSimdLevel(); ++level) {
+        levels.push_back((SimdLevel)level);
+    }
+    return levels;
+}
+
+// The SIMD kernels must match their scalar references bit for bit; checked
+// over a few hundred steps before either is timed. Each kernel the CPU can
+// run is checked on an odd-sized world, so the narrower tails run too; the
+// timed sizes use the widest.
+static bool BenchKernels(BenchRunner& bench) {
+    const float step = 1.0f / 60.0f;
+    const int CHECK_STEPS = 300;
+    bool matched = true;
+
+    for (SimdLevel level : GetSimdLevels()) {
+        CpuFeatures::SetSimdLimit(level);
+        if (!CheckMotion(10001, CHECK_STEPS) || !CheckAnimation(10001, CHECK_STEPS)) {
+            std::cerr << "Kernels differ from the reference with " << CpuFeatures::GetSimdLevelName(level) << std::endl;
+            matched = false;
+        }
+    }
+    CpuFeatures::SetSimdLimit(SimdLevel::AVX2);
+
+    // Timed as a level steps: motion, then the transform system's update
+    for (size_t n : {1000, 100000, 1000000}) {
+        if (!CheckMotion(n, CHECK_STEPS)) {
+            matched = false;
+        }
+
+        std::mt19937 gen(1234), referenceGen(1234);
+        TransformSystem transforms, referenceTransforms;
+        int root = transforms.CreateNode();
+        int referenceRoot = referenceTransforms.CreateNode();
+        MotionSystem motion(&transforms, root);
+        MotionSystem reference(&referenceTransforms, referenceRoot);
+        PopulateMotion(transforms, motion, root, n, gen);
+        PopulateMotion(referenceTransforms, reference, referenceRoot, n, referenceGen);
+
+        bench.Run("MotionSystem::Update+TransformSystem::Update", n, n, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                motion.Update(step);
+                transforms.Update();
+            }
+        });
+        bench.Run("MotionSystem::UpdateReference", n, n, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                reference.UpdateReference(step);
+            }
+        });
+    }
+
+    for (size_t n : {1000, 100000, 1000000}) {
+        if (!CheckAnimation(n, CHECK_STEPS)) {
+            matched = false;
+        }
+
+        std::mt19937 gen(1234), referenceGen(1234);
+        AnimationSystem animation, reference;
+        animation.ShareClips(*AnimationSystem::GetInstance());
+        reference.ShareClips(*AnimationSystem::GetInstance());
+        PopulateAnimation(animation, n, gen);
+        PopulateAnimation(reference, n, referenceGen);
+
+        bench.Run("AnimationSystem::Update", n, n, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                animation.Update(step);
+            }
+        });
+        bench.Run("AnimationSystem::UpdateReference", n, n, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                reference.UpdateReference(step);
+            }
+        });
+    }
+
+    return matched;
+}
+
+// Premultiplied pixels in runs of opaque, transparent and partly covered
+// texels, so the rasterizer's copy, skip and blend paths all run
+static void FillRasterImage(RasterImage& image, int width, int height, std::mt19937& gen) {
+    std::uniform_int_distribution<int> byte(0, 255);
+    image.Width = width;
+    image.Height = height;
+    image.Pixels.resize((size_t)width * height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int run = (x / 13 + y / 7) % 4;
+            Uint32 alpha = run == 0 ? 255 : run == 1 ? 0 : (Uint32)byte(gen);
+            std::uniform_int_distribution<Uint32> channel(0, alpha);
+            image.Pixels[(size_t)y * width + x] =
+                channel(gen) | (channel(gen) << 8) | (channel(gen) << 16) | (alpha << 24);
+        }
+    }
+}
+
+// Draws a frame of sprites, scaled and unscaled, some hanging off the
+// edges, plus outlines, once per instruction set the CPU runs. Every
+// framebuffer must match the scalar one exactly.
+static bool BenchRaster(BenchRunner& bench) {
+    const int WIDTH = 1920, HEIGHT = 1080;
+    std::mt19937 gen(4321);
+    std::vector<RasterImage> images(3);
+    for (RasterImage& image : images) {
+        FillRasterImage(image, 96, 64, gen);
+    }
+
+    std::uniform_real_distribution<float> x(-100.0f, (float)WIDTH), y(-100.0f, (float)HEIGHT);
+    std::uniform_real_distribution<float> scale(0.5f, 2.5f);
+    std::vector<RasterDraw> draws(2000);
+    for (size_t i = 0; i < draws.size(); ++i) {
+        RasterDraw& draw = draws[i];
+        draw.Image = (i % 16 == 0) ? nullptr : &images[i % images.size()];
+        draw.Src = {0.0f, 0.0f, 96.0f, 64.0f};
+        float s = (i % 2 == 0) ? 1.0f : scale(gen);
+        draw.Dest = {std::floor(x(gen)), std::floor(y(gen)), 96.0f * s, 64.0f * s};
+        draw.Color = {255, 40, 40, 160};
+    }
+    std::vector<SDL_Rect> regions = {{0, 0, WIDTH, HEIGHT}};
+    SDL_Color clear = {30, 60, 90, 255};
+
+    SoftwareRasterizer raster;
+    raster.Resize(WIDTH, HEIGHT);
+    raster.SetThreadCount(1);
+
+    bool matched = true;
+    std::vector<Uint32> scalar;
+    for (SimdLevel level : GetSimdLevels()) {
+        CpuFeatures::SetSimdLimit(level);
+        raster.DrawBatch(draws, regions, clear);
+        std::vector<Uint32> pixels(raster.GetPixels(), raster.GetPixels() + (size_t)WIDTH * HEIGHT);
+        if (scalar.empty()) {
+            scalar.swap(pixels);
+        } else if (pixels != scalar) {
+            std::cerr << "SoftwareRasterizer output with " << CpuFeatures::GetSimdLevelName(level)
+                      << " differs from scalar" << std::endl;
+            matched = false;
+        }
+
+        std::string name = std::string("SoftwareRasterizer::DrawBatch (") + CpuFeatures::GetSimdLevelName(level) + ")";
+        bench.Run(name, draws.size(), draws.size(), [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                raster.DrawBatch(draws, regions, clear);
+            }
+        });
+    }
+    CpuFeatures::SetSimdLimit(SimdLevel::AVX2);
+    return matched;
+}
+
+// A camera root with count / 10 entities under it, each carrying nine
+// attachments; returns the entity nodes
+static std::vector<int> PopulateTransforms(TransformSystem& transforms, size_t count, std::mt19937& gen) {
+    std::uniform_real_distribution<float> position(-100.0f, 1920.0f);
+    std::uniform_real_distribution<float> offset(-32.0f, 32.0f);
+    std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+    int root = transforms.CreateNode();
+    std::vector<int> entities;
+    for (size_t i = 0; i < count / 10; ++i) {
+        int entity = transforms.CreateNode(root);
+        transforms.SetLocal(entity, {position(gen), position(gen), scale(gen)});
+        for (int j = 0; j < 9; ++j) {
+            int attachment = transforms.CreateNode(entity);
+            transforms.SetLocal(attachment, {offset(gen), offset(gen), scale(gen)});
+        }
+        entities.push_back(entity);
+    }
+    return entities;
+}
+
+// Incremental updates must match a full recompute; timed with nothing
+// changed, with every entity set through SetLocalPosition (the queued path
+// that MotionSystem bypasses), and against the full recompute
+static bool BenchTransforms(BenchRunner& bench) {
+    const int CHECK_STEPS = 300;
+    bool matched = true;
+
+    for (size_t n : {1000, 100000}) {
+        std::mt19937 gen(1234);
+        TransformSystem transforms;
+        std::vector<int> entities = PopulateTransforms(transforms, n, gen);
+        TransformSystem reference = transforms;
+
+        // Moves a few entities each step and the camera now and then, with
+        // the odd attachment handed to another entity
+        std::uniform_int_distribution<size_t> pick(0, entities.size() - 1);
+        std::uniform_real_distribution<float> position(-100.0f, 1920.0f);
+        for (int step = 0; step < CHECK_STEPS && matched; ++step) {
+            for (int k = 0; k < 8; ++k) {
+                int entity = entities[pick(gen)];
+                float x = position(gen), y = position(gen);
+                transforms.SetLocalPosition(entity, x, y);
+                reference.SetLocalPosition(entity, x, y);
+            }
+            if (step % 50 == 0) {
+                transforms.SetLocalPosition(0, (float)step, 0.0f);
+                reference.SetLocalPosition(0, (float)step, 0.0f);
+            }
+            if (step % 30 == 0) {
+                int attachment = entities[pick(gen)] + 1;
+                int entity = entities[pick(gen)];
+                transforms.SetParent(attachment, entity);
+                reference.SetParent(attachment, entity);
+            }
+
+            transforms.Update();
+            reference.UpdateReference();
+            matched = SameWorld(transforms, reference, transforms.GetNodeCount());
+        }
+
+        bench.Run("TransformSystem::Update (static)", n, n, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                transforms.Update();
+            }
+        });
+        bench.Run("TransformSystem::Update (entities set)", n, n, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                for (int entity : entities) {
+                    transforms.SetLocalPosition(entity, (float)i, (float)i);
+                }
+                transforms.Update();
+            }
+        });
+        bench.Run("TransformSystem::UpdateReference", n, n, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                reference.UpdateReference();
+            }
+        });
+    }
+
+    return matched;
+}
+
+static void BenchTextureLookup(BenchRunner& bench, Renderer* renderer) {
+    const char* sheets[] = {
+        "Assets/Textures/warrior_run.tga",
+        "Assets/Textures/warrior_death.tga",
+        "Assets/Textures/rock.tga"
+    };
+
+    for (size_t n : {8, 128}) {
+        std::vector<Texture*> textures;
+        for (size_t i = 0; i < n; ++i) {
+            Texture* texture = Texture::Pool->GetResource();
+            texture->Load(sheets[i % 3]);
+            renderer->GetSDLTexture(texture);
+            textures.push_back(texture);
+        }
+
+        bench.Run("Renderer::GetSDLTexture", n, n, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                for (Texture* texture : textures) {
+                    Consume(renderer->GetSDLTexture(texture));
+                }
+            }
+        });
+
+        for (Texture* texture : textures) {
+            renderer->ReleaseUploadedTexture(texture);
+            texture->Unload();
+            Texture::Pool->ReturnResource(texture);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string outputPath = "SDLLevels_bench.json";
+    std::string filter;
+    double minTimeMs = 20.0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--out=", 0) == 0) {
+            outputPath = arg.substr(6);
+        } else if (arg.rfind("--filter=", 0) == 0) {
+            filter = arg.substr(9);
+        } else if (arg.rfind("--min-time-ms=", 0) == 0) {
+            minTimeMs = std::stod(arg.substr(14));
+        } else {
+            std::cerr << "Usage: SDLLevels_bench [--out=<file.json>] [--filter=<text>] [--min-time-ms=<N>]" << std::endl;
+            return 1;
+        }
+    }
+
+    SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "dummy");
+
+    World* world = new World(20, 20, 0, AnimationSystem::GetInstance());
+    World::SetDefault(world);
+    Texture::Pool = new ObjectPool<Texture>(10, "Texture");
+
+    // Budgets off, so lookups never trigger eviction mid-sample
+    ResidencyManager::GetInstance()->SetBudgets(0, 0);
+    Renderer* renderer = Renderer::GetInstance();
+    bool haveRenderer = renderer->Initialize("SDLLevels_bench", 1920, 1080);
+
+    if (!AnimationSystem::GetInstance()->LoadClips("Assets/Animations/clips.txt")) {
+        std::cerr << "Failed to load animation clips; run from the directory containing Assets/" << std::endl;
+        return 1;
+    }
+
+    BenchRunner bench(filter, minTimeMs);
+    BenchRunner::PrintHeader();
+    BenchTGA(bench);
+    BenchObjectPool(bench);
+    BenchStackAllocator(bench);
+    BenchLevels(bench);
+    bool kernelsMatched = BenchKernels(bench);
+    bool rasterMatched = BenchRaster(bench);
+    bool transformsMatched = BenchTransforms(bench);
+    bool schedulerMatched = BenchScheduler(bench);
+    if (haveRenderer) {
+        BenchTextureLookup(bench, renderer);
+    } else {
+        std::cerr << "Skipping renderer benchmarks: no SDL video driver" << std::endl;
+    }
+
+    bool written = bench.WriteJson(outputPath);
+
+    Renderer::DestroyInstance();
+    delete world;
+    AnimationSystem::DestroyInstance();
+    delete Texture::Pool;
+    Texture::Pool = nullptr;
+    ResidencyManager::DestroyInstance();
+    AssetController::DestroyInstance();
+    FileController::DestroyInstance();
+
+    return written && kernelsMatched && rasterMatched && transformsMatched && schedulerMatched ? 0 : 1;
+}